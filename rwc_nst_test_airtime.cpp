@@ -0,0 +1,29 @@
+/*
+
+Module:  rwc_nst_test_airtime.cpp
+
+Function:
+    cAirtime symbol timing table.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_airtime.h"
+
+// every entry is a constant expression, so the table is built by the
+// compiler and lives in flash. The order must match symbolTableIndex().
+const cAirtime::SymbolTiming_t cAirtime::kSymbolTable[cAirtime::kSymbolTableSize] =
+    {
+    makeSymbolTiming(SF7,  BW125), makeSymbolTiming(SF7,  BW250), makeSymbolTiming(SF7,  BW500),
+    makeSymbolTiming(SF8,  BW125), makeSymbolTiming(SF8,  BW250), makeSymbolTiming(SF8,  BW500),
+    makeSymbolTiming(SF9,  BW125), makeSymbolTiming(SF9,  BW250), makeSymbolTiming(SF9,  BW500),
+    makeSymbolTiming(SF10, BW125), makeSymbolTiming(SF10, BW250), makeSymbolTiming(SF10, BW500),
+    makeSymbolTiming(SF11, BW125), makeSymbolTiming(SF11, BW250), makeSymbolTiming(SF11, BW500),
+    makeSymbolTiming(SF12, BW125), makeSymbolTiming(SF12, BW250), makeSymbolTiming(SF12, BW500),
+    makeSymbolTiming(FSK,  BW125),
+    };
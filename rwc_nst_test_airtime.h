@@ -0,0 +1,169 @@
+/*
+
+Module:  rwc_nst_test_airtime.h
+
+Function:
+    Compile-time capable LoRa and FSK airtime calculations.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#ifndef _rwc_nst_test_airtime_h_
+# define _rwc_nst_test_airtime_h_
+
+#pragma once
+
+#include <cstdint>
+#include <arduino_lmic.h>
+
+/****************************************************************************\
+|
+|   cAirtime: time on air for a frame, from the Semtech SX127x datasheet.
+|
+\****************************************************************************/
+
+class cAirtime
+    {
+public:
+    // symbol timing for one SF/BW pair, in microseconds and os ticks.
+    // For FSK, a "symbol" is one byte, as for LMIC.rxsyms.
+    struct SymbolTiming_t
+        {
+        sf_t            sf;
+        bw_t            bw;
+        std::uint32_t   symbolUs;
+        std::uint32_t   halfSymbolUs;
+        // the default (LoRaWAN) preamble, kPreambleSymbols plus sync
+        std::uint32_t   preambleUs;
+        ostime_t        symbolTicks;
+        ostime_t        halfSymbolTicks;
+        ostime_t        preambleTicks;
+        };
+
+    static constexpr unsigned kPreambleSymbols = 8;
+    // SF7..SF12 at each of 125, 250 and 500 kHz, then FSK.
+    static constexpr unsigned kSymbolTableSize = 6 * 3 + 1;
+    static const SymbolTiming_t kSymbolTable[kSymbolTableSize];
+
+    // LMIC FSK framing: 50 kbps; 5 preamble bytes, 3 sync bytes,
+    // a length byte and a 2-byte CRC around the payload.
+    static constexpr std::uint32_t kFskBitUs = 20;
+    static constexpr std::uint32_t kFskOverheadBytes = 5 + 3 + 1 + 2;
+
+    // convert an sf_t (SF7..SF12) to the spreading factor 7..12.
+    static constexpr unsigned sfNumber(sf_t sf)
+        {
+        return sf - SF7 + 7;
+        }
+
+    // LoRa symbol time, 2^SF / BW, in microseconds. Exact for all
+    // SF7..SF12 at 125, 250 and 500 kHz.
+    static constexpr std::uint32_t loraSymbolUs(sf_t sf, bw_t bw)
+        {
+        return (std::uint32_t(1) << sfNumber(sf)) * 8u >> bw;
+        }
+
+    // the LMIC enables low data rate optimization for SF11 and SF12
+    // at 125 kHz.
+    static constexpr bool loraLowDataRate(sf_t sf, bw_t bw)
+        {
+        return bw == BW125 && (sf == SF11 || sf == SF12);
+        }
+
+    // preamble (nPreamble programmed symbols plus 4.25 sync symbols),
+    // in microseconds.
+    static constexpr std::uint32_t loraPreambleUs(sf_t sf, bw_t bw, unsigned nPreamble)
+        {
+        return (4u * nPreamble + 17u) * loraSymbolUs(sf, bw) / 4u;
+        }
+
+    // number of payload symbols, including the 8 fixed symbols.
+    static constexpr std::uint32_t loraPayloadSymbols(
+        sf_t sf, bw_t bw, cr_t cr, bool fCrc, bool fImplicitHeader, unsigned nPayload
+        )
+        {
+        return 8u + loraPayloadBlocks(
+                        std::int32_t(8 * nPayload) - std::int32_t(4 * sfNumber(sf)) + 28 +
+                            (fCrc ? 16 : 0) - (fImplicitHeader ? 20 : 0),
+                        std::int32_t(4 * (sfNumber(sf) - (loraLowDataRate(sf, bw) ? 2 : 0)))
+                        ) * (cr - CR_4_5 + 5u);
+        }
+
+    // total LoRa time on air, in microseconds.
+    static constexpr std::uint32_t loraUs(
+        sf_t sf, bw_t bw, cr_t cr, bool fCrc, bool fImplicitHeader,
+        unsigned nPreamble, unsigned nPayload
+        )
+        {
+        return loraPreambleUs(sf, bw, nPreamble) +
+               loraPayloadSymbols(sf, bw, cr, fCrc, fImplicitHeader, nPayload) *
+                    loraSymbolUs(sf, bw);
+        }
+
+    // total FSK time on air, in microseconds.
+    static constexpr std::uint32_t fskUs(unsigned nPayload)
+        {
+        return (kFskOverheadBytes + nPayload) * 8u * kFskBitUs;
+        }
+
+    // compute a symbol table entry; used to build kSymbolTable.
+    static constexpr SymbolTiming_t makeSymbolTiming(sf_t sf, bw_t bw)
+        {
+        return sf == FSK
+            ? SymbolTiming_t
+                {
+                sf, bw,
+                8u * kFskBitUs,
+                4u * kFskBitUs,
+                5u * 8u * kFskBitUs,
+                us2osticksRound(8u * kFskBitUs),
+                us2osticksRound(4u * kFskBitUs),
+                us2osticksRound(5u * 8u * kFskBitUs)
+                }
+            : SymbolTiming_t
+                {
+                sf, bw,
+                loraSymbolUs(sf, bw),
+                loraSymbolUs(sf, bw) / 2u,
+                loraPreambleUs(sf, bw, kPreambleSymbols),
+                us2osticksRound(loraSymbolUs(sf, bw)),
+                us2osticksRound(loraSymbolUs(sf, bw) / 2u),
+                us2osticksRound(loraPreambleUs(sf, bw, kPreambleSymbols))
+                };
+        }
+
+    // index of the kSymbolTable entry for an SF/BW pair.
+    static constexpr unsigned symbolTableIndex(sf_t sf, bw_t bw)
+        {
+        return sf == FSK ? kSymbolTableSize - 1
+                         : (sf - SF7) * 3u + (bw > BW500 ? unsigned(BW500) : unsigned(bw));
+        }
+
+    // look up the symbol timing for an SF/BW pair.
+    static const SymbolTiming_t &symbolTiming(sf_t sf, bw_t bw)
+        {
+        return kSymbolTable[symbolTableIndex(sf, bw)];
+        }
+
+private:
+    // ceil(num / den), or zero if num is not positive.
+    static constexpr std::uint32_t loraPayloadBlocks(std::int32_t num, std::int32_t den)
+        {
+        return num <= 0 ? 0u : std::uint32_t((num + den - 1) / den);
+        }
+    };
+
+// spot checks: 4-byte frames, explicit header, CRC on
+static_assert(cAirtime::loraUs(SF7, BW125, CR_4_5, true, false, 8, 4) == 30976, "SF7 airtime");
+static_assert(cAirtime::loraUs(SF12, BW125, CR_4_5, true, false, 8, 4) == 827392, "SF12 airtime");
+// the half-symbol time the rx window calculation used to derive at run time
+static_assert(cAirtime::makeSymbolTiming(SF7, BW125).halfSymbolUs == (128u << (7 - 0 - 5)), "SF7 half symbol");
+static_assert(cAirtime::makeSymbolTiming(SF12, BW500).halfSymbolUs == (128u << (12 - 2 - 5)), "SF12 half symbol");
+static_assert(cAirtime::symbolTableIndex(SF12, BW500) == cAirtime::kSymbolTableSize - 2, "symbol table size");
+
+#endif // _rwc_nst_test_airtime_h_
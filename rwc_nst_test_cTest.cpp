@@ -14,6 +14,8 @@ Author:
 */
 
 #include "rwc_nst_test.h"
+#include "rwc_nst_test_airtime.h"
+#include "rwc_nst_test_radio.h"
 
 #include <strings.h>
 #include <mcciadk_baselib.h>
@@ -73,16 +75,8 @@ cTest::State cTest::fsmDispatch(
     switch(currentState)
         {
     case State::stInitial:
-        {
-        static const std::uint8_t defaultData[] =
-            { 0xCA, 0xFE, 0xF0, 0x0D };
-
         newState = State::stIdle;
         this->m_params = kDefaultParams();
-
-        memcpy(this->m_Tx.Data, defaultData, sizeof(defaultData));
-        this->m_Tx.nData = sizeof(defaultData);
-        }
         break;
 
     case State::stIdle:
@@ -110,6 +104,20 @@ cTest::State cTest::fsmDispatch(
             case Command::StartTxWindow:
                 newState = State::stTxWindowTest;
                 break;
+            case Command::StartTxBurst:
+                newState = State::stTxBurstTest;
+                break;
+            case Command::StartTxCw:
+                this->m_Tx.Carrier.fCw = true;
+                newState = State::stTxCarrierTest;
+                break;
+            case Command::StartTxPreamble:
+                this->m_Tx.Carrier.fCw = false;
+                newState = State::stTxCarrierTest;
+                break;
+            case Command::StartSweep:
+                newState = State::stSweepTest;
+                break;
 
             default:
                 // ignore
@@ -139,6 +147,21 @@ cTest::State cTest::fsmDispatch(
             newState = State::stIdle;
         break;
 
+    case State::stTxBurstTest:
+        if (this->txBurstTest(fEntry))
+            newState = State::stIdle;
+        break;
+
+    case State::stTxCarrierTest:
+        if (this->txCarrierTest(fEntry))
+            newState = State::stIdle;
+        break;
+
+    case State::stSweepTest:
+        if (this->sweepTest(fEntry))
+            newState = State::stIdle;
+        break;
+
     case State::stFinal:
         break;
 
@@ -154,7 +177,7 @@ void cTest::setupLMIC(const cTest::Params &params)
     {
     LMIC_reset();
     LMIC.freq = params.Freq;
-    LMIC.rps = makeRps(params.SpreadingFactor, params.Bandwidth, params.CodingRate, 0, 0);
+    LMIC.rps = getRps(params);
     LMIC.noRXIQinversion = true;
     LMIC.lbt_ticks = us2osticks(params.RxRssiIntervalUs);
     LMIC.lbt_dbmax = params.RxRssiDbMax;
@@ -165,8 +188,7 @@ void cTest::setupLMIC(const cTest::Params &params)
     else
         LMIC.rxsyms = rxsym_t(params.RxSyms);
 
-    float clockError = std_fabsf(params.ClockError * MAX_CLOCK_ERROR / 100.0f) + 0.5f;
-    LMIC_setClockError(clockError >= UINT16_MAX ? UINT16_MAX : u2_t(clockError));
+    setClockError(params.ClockError);
 
     gCatena.SafePrintf("Freq=%u Hz, ", LMIC.freq);
     if (getSf(LMIC.rps) == FSK)
@@ -174,32 +196,161 @@ void cTest::setupLMIC(const cTest::Params &params)
     else
         {
         gCatena.SafePrintf(
-            "LoRa SF%u, BW%u",
+            "LoRa SF%u, BW%u, Preamble=%u, SyncWord=0x%02x, ",
             getSf(LMIC.rps) + 6,
-            125 << getBw(LMIC.rps)
+            125 << getBw(LMIC.rps),
+            params.Preamble,
+            params.SyncWord
             );
+        if (getIh(LMIC.rps))
+            gCatena.SafePrintf("implicit header (%u bytes)", getIh(LMIC.rps));
+        else
+            gCatena.SafePrintf("explicit header");
         }
 
     u2_t ceppk = LMIC.client.clockError * 1000 / MAX_CLOCK_ERROR;
 
     gCatena.SafePrintf(
-        ", TxPwr=%d dB, CR 4/%u, CRC=%u, LBT=%u us/%d dB, clockError=%u.%u (0x%x), RxSyms=%u\n",
+        ", TxPwr=%d dB, CR 4/%u, CRC=%u, LBT=%u us/%d dB, clockError=%u.%u (0x%x), RxSyms=%u"
+        ", symbol=%lu us, airtime=%lu us (%u bytes)\n",
         LMIC.radio_txpow,
         getCr(LMIC.rps) + 5 - CR_4_5,
         ! getNocrc(LMIC.rps),
         osticks2us(LMIC.lbt_ticks),
         LMIC.lbt_dbmax,
         ceppk / 10, ceppk % 10, LMIC.client.clockError,
-        LMIC.rxsyms
+        LMIC.rxsyms,
+        (unsigned long) cAirtime::symbolTiming(getSf(LMIC.rps), getBw(LMIC.rps)).symbolUs,
+        (unsigned long) getTxAirtimeUs(params),
+        params.TxLength
         );
     }
 
+void cTest::setClockError(float percent)
+    {
+    float clockError = std_fabsf(percent * MAX_CLOCK_ERROR / 100.0f) + 0.5f;
+    LMIC_setClockError(clockError >= UINT16_MAX ? UINT16_MAX : u2_t(clockError));
+    }
+
+rps_t cTest::getRps(const cTest::Params &params)
+    {
+    return makeRps(
+                params.SpreadingFactor,
+                params.Bandwidth,
+                params.CodingRate,
+                params.ImplicitLength,
+                ! params.Crc
+                );
+    }
+
+// Start a radio operation (os_radio() mode) with the LoRa profile
+// applied. The LMIC leaves RegPreamble alone, so the preamble length is
+// written first, while the radio is idle. It does rewrite the sync word
+// as it starts each operation, so a private sync word is applied by
+// re-entering the operation just after it starts.
+void cTest::startRadio(std::uint8_t mode)
+    {
+    bool const fLora = getSf(LMIC.rps) != FSK;
+
+    if (fLora)
+        cRadio::setLoraPreamble(this->m_params.Preamble);
+
+    os_radio(mode);
+
+    if (fLora && this->m_params.SyncWord != kSyncWordPublic)
+        cRadio::restartWithSyncWord(this->m_params.SyncWord);
+    }
+
+std::uint32_t cTest::getTxAirtimeUs(const cTest::Params &params)
+    {
+    if (params.SpreadingFactor == FSK)
+        return cAirtime::fskUs(params.TxLength);
+    else
+        return cAirtime::loraUs(
+                    params.SpreadingFactor,
+                    params.Bandwidth,
+                    params.CodingRate,
+                    params.Crc,
+                    params.ImplicitLength != 0,
+                    params.Preamble,
+                    params.TxLength
+                    );
+    }
+
+ostime_t cTest::getTxIntervalTicks(const cTest::Params &params)
+    {
+    if (params.TxInterval == kTxIntervalAuto)
+        return us2osticksCeil(getTxAirtimeUs(params) + params.TxAutoGuardUs);
+    else
+        return ms2osticks(params.TxInterval);
+    }
+
 void cTest::txTestDone(osjob_t *job)
     {
-    gTest.m_Tx.fIdle = true;
+    auto &tx = gTest.m_Tx;
+
+    // the LMIC keys the transmitter tStartup ahead of the scheduled
+    // start, so that's the target. Back-to-back frames have no target.
+    if (! tx.fBackToBack)
+        tx.StartError.add(float(osticks2us(tx.tStart - (tx.tScheduled - tx.tStartup))));
+    gTest.txOnAirRecord();
+    gTest.dutyCycleRecord(tx.tStart, tx.AirtimeUs);
+    if (gTest.m_params.TxLed)
+        digitalWrite(LED_BUILTIN, 0);
+    tx.fIdle = true;
     gTest.m_fsm.eval();
     }
 
+void cTest::txOnAirReset()
+    {
+    this->m_Tx.AirtimeUs = getTxAirtimeUs(this->m_params);
+    this->m_Tx.OnAirError.reset();
+    }
+
+// LMIC.txend is the time of the tx-done interrupt; m_Tx.tStart is when
+// the LMIC keyed the transmitter.
+void cTest::txOnAirRecord()
+    {
+    auto &tx = this->m_Tx;
+    auto const tOnAir = osticks2us(LMIC.txend - tx.tStart);
+
+    tx.OnAirError.add(float(tOnAir) - float(tx.AirtimeUs));
+    }
+
+void cTest::txTestPrintStats()
+    {
+    auto const &se = this->m_Tx.StartError;
+    auto const &oe = this->m_Tx.OnAirError;
+
+    if (se.getCount() != 0)
+        {
+        gCatena.SafePrintf(
+            "Tx start error: %lu packets, mean %ld us, min %ld us, max %ld us, stddev %ld us\n",
+            (unsigned long) se.getCount(),
+            long(se.getMean()),
+            long(se.getMin()),
+            long(se.getMax()),
+            long(se.getStdDev())
+            );
+        }
+
+    if (oe.getCount() != 0)
+        {
+        float const worst = -oe.getMin() > oe.getMax() ? oe.getMin() : oe.getMax();
+
+        gCatena.SafePrintf(
+            "Tx on-air time: computed %lu us, measured mean %ld us; deviation mean %ld us, worst %ld us\n",
+            (unsigned long) this->m_Tx.AirtimeUs,
+            long(this->m_Tx.AirtimeUs + oe.getMean()),
+            long(oe.getMean()),
+            long(worst)
+            );
+        }
+
+    if (this->getDutyCycleBudgetUs() != 0)
+        this->dutyCyclePrintStatus();
+    }
+
 // transmit test driver
 bool cTest::txTest(
     bool fEntry
@@ -211,16 +362,36 @@ bool cTest::txTest(
         this->m_Tx.Count = this->m_params.TxTestCount;
         this->m_Tx.fIdle = true;
         this->m_Tx.fContinuous = this->m_Tx.Count == 0;
-        this->m_Tx.Tnext = os_getTime();
+        this->m_Tx.tGuard = us2osticksRound(this->m_params.TxGuardUs);
+        this->m_Tx.tStartup = us2osticksRound(this->m_params.TxStartUs);
+        this->m_Tx.fBackToBack = getTxIntervalTicks(this->m_params) == 0;
+        this->m_Tx.StartError.reset();
+        this->txOnAirReset();
+        this->m_Tx.nSent = 0;
+
+        if (! this->buildTxPayload() || ! this->dutyCycleCheck(this->m_Tx.AirtimeUs))
+            return true;
         this->m_TxDigOut.setOutput(this->m_params.TxDigOut, true);
 
-        gCatena.SafePrintf("Start TX test: %u bytes, ", this->m_Tx.nData);
+        gCatena.SafePrintf(
+            "Start TX test: %u bytes (%s), ",
+            this->m_Tx.nData,
+            getTxPatternName(this->m_params.TxPatternKind)
+            );
 
         if (m_Tx.fContinuous)
             gCatena.SafePrintf("continous");
         else
             gCatena.SafePrintf("%u packets", this->m_Tx.Count);
 
+        if (this->m_params.TxInterval == kTxIntervalAuto)
+            gCatena.SafePrintf(
+                " every %ld us (auto)",
+                (long) osticks2us(getTxIntervalTicks(this->m_params))
+                );
+        else
+            gCatena.SafePrintf(" every %u ms", this->m_params.TxInterval);
+
         if (this->m_TxDigOut.isEnabled())
             {
             gCatena.SafePrintf(" pulsing digital I/O %d", this->m_params.TxDigOut);
@@ -229,6 +400,17 @@ bool cTest::txTest(
         // setup LMIC and print settings
         gCatena.SafePrintf(". ");
         this->setupLMIC(this->m_params);
+
+        // reset the radio, once.
+        os_radio(RADIO_RST);
+
+        // load up the buffer; nothing else touches LMIC.frame during
+        // the test, so this is only done once.
+        memcpy(LMIC.frame, this->m_Tx.Data, this->m_Tx.nData);
+        LMIC.dataLen = this->m_Tx.nData;
+
+        // first frame goes out one guard time from now.
+        this->m_Tx.Tnext = os_getTime() + this->m_Tx.tGuard;
         }
 
     os_runloop_once();
@@ -238,26 +420,49 @@ bool cTest::txTest(
     else if (this->m_fStopTest)
         {
         gCatena.SafePrintf("\nTX test stopped.\n");
+        this->txTestPrintStats();
         return true;
         }
     else if (this->m_Tx.Count == 0 && ! this->m_Tx.fContinuous)
         {
         // all done.
         gCatena.SafePrintf("\nTx test complete.\n");
+        this->txTestPrintStats();
         return true;
         }
-    else if ((os_getTime() - this->m_Tx.Tnext) < 0)
+    else if ((os_getTime() - (this->m_Tx.Tnext - this->m_Tx.tGuard)) < 0)
         {
         // waiting for time to go.
         return false;
         }
+    else if (! cRadio::isIdle())
+        {
+        // radio still finishing the last operation.
+        return false;
+        }
+    else if (auto const tWait = this->dutyCycleDelay(this->m_Tx.AirtimeUs))
+        {
+        // over the duty-cycle budget: restart the grid when it fits.
+        this->m_Tx.Tnext = os_getTime() + tWait + this->m_Tx.tGuard;
+        return false;
+        }
     else
         {
-        // advance time
-        this->m_Tx.Tnext += ms2osticks(this->m_params.TxInterval);
-
-        // reset the radio.
-        os_radio(RADIO_RST);
+        auto const tNow = os_getTime();
+
+        // With TxInterval 0 there's no grid: key the transmitter now.
+        // Otherwise, if less than half the guard time is left, the
+        // grid has fallen behind (an interval shorter than a frame, or
+        // a slow loop), so restart it a guard time from now.
+        if (this->m_Tx.fBackToBack)
+            this->m_Tx.Tnext = tNow + this->m_Tx.tStartup;
+        else if (this->m_Tx.Tnext - tNow < this->m_Tx.tGuard / 2)
+            this->m_Tx.Tnext = tNow + this->m_Tx.tGuard;
+
+        // advance time; the frames are scheduled on a fixed grid, so
+        // poll latency doesn't accumulate.
+        this->m_Tx.tScheduled = this->m_Tx.Tnext;
+        this->m_Tx.Tnext += getTxIntervalTicks(this->m_params);
 
         // print a dot
         gCatena.SafePrintf(".");
@@ -265,20 +470,33 @@ bool cTest::txTest(
         if (! this->m_Tx.fContinuous)
             --this->m_Tx.Count;
 
-        // give radio time to responsd to reset
-        digitalWrite(LED_BUILTIN, 1);
-        delay(1);
-        digitalWrite(LED_BUILTIN, 0);
+        // the frame is already loaded; just update the counter.
+        this->patchTxPayload(
+            this->m_Tx.nSent++,
+            this->m_Tx.fBackToBack ? tNow : this->m_Tx.tScheduled
+            );
 
-        // load up the buffer.
-        memcpy(LMIC.frame, this->m_Tx.Data, this->m_Tx.nData);
-        LMIC.dataLen = this->m_Tx.nData;
+        // LED is lit until txTestDone()
+        if (this->m_params.TxLed)
+            digitalWrite(LED_BUILTIN, 1);
 
         // set the done function
         LMIC.osjob.func = cTest::txTestDone;
 
         this->m_Tx.fIdle = false;
-        os_radio(RADIO_TX);
+        this->m_Tx.fStartSeen = false;
+        LMIC.txend = this->m_Tx.tScheduled - this->m_Tx.tStartup;
+
+#if ARDUINO_LMIC_VERSION >= ARDUINO_LMIC_VERSION_CALC(3,0,99,8)
+        this->startRadio(RADIO_TX_AT);
+#else
+        this->startRadio(RADIO_TX);
+#endif
+
+        // if the LMIC didn't log the start, the radio has been keyed
+        // by the time os_radio() returns.
+        if (! this->m_Tx.fStartSeen)
+            this->m_Tx.tStart = os_getTime();
         return false;
         }
     }
@@ -292,9 +510,12 @@ void cTest::evStopTest()
 // receive window test driver
 // fEntry is true to start a test, false subequently.
 // The receive window test waits for a rising edge on a specified
-// digital line (param RxDigIn), and captures the os_getTime() value.
-// It then starts a single receive scheduled at `param RxWindow`, using
-// RxSyms and ClockError to simulate the LMIC's window.
+// digital line (param RxDigIn), and captures the os_getTime() value
+// (from an interrupt if the pin has one, so loop latency doesn't add
+// jitter). It then starts a single receive scheduled at `param RxWindow`, using
+// RxSyms and ClockError to simulate the LMIC's window. Params
+// Window.RxSyms and Window.ClockError make a grid: the whole window
+// sweep or search is repeated for each combination.
 // This process repeats (controlled by param RxCount), and counts of pulses
 // and successful receives are accumulated.
 bool cTest::rxWindowTest(
@@ -307,17 +528,43 @@ bool cTest::rxWindowTest(
         if (! this->m_RwTest.begin(*this))
             return true;
 
-        gCatena.SafePrintf(
-            "Start RX Window test: vary window from %ld to %ld us in %ld us steps, %u tries each step\n",
-            (long) osticks2us(this->m_RwTest.WindowStart),
-            (long) osticks2us(this->m_RwTest.WindowStop),
-            (long) osticks2us(this->m_RwTest.WindowStep),
-            this->m_RwTest.Count
-            );
+        if (this->m_RwTest.Mode == WindowMode::Search)
+            gCatena.SafePrintf(
+                "Start RX Window test: search for edges from %ld to %ld us to %ld us, up to %u tries each probe\n",
+                (long) osticks2us(this->m_RwTest.WindowStart),
+                (long) osticks2us(this->m_RwTest.WindowStop),
+                (long) osticks2us(this->m_RwTest.WindowStep),
+                this->m_RwTest.Count
+                );
+        else if (this->m_RwTest.Mode == WindowMode::Measure)
+            gCatena.SafePrintf(
+                "Start RX Window test: measure arrival in a window from %ld to %ld us, %u tries\n",
+                (long) osticks2us(this->m_RwTest.WindowStart),
+                (long) osticks2us(this->m_RwTest.WindowStop),
+                this->m_RwTest.Count
+                );
+        else
+            gCatena.SafePrintf(
+                "Start RX Window test: vary window from %ld to %ld us in %ld us steps, %s%u tries each step, %s\n",
+                (long) osticks2us(this->m_RwTest.WindowStart),
+                (long) osticks2us(this->m_RwTest.WindowStop),
+                (long) osticks2us(this->m_RwTest.WindowStep),
+                this->m_RwTest.Width > 0.0f ? "up to " : "",
+                this->m_RwTest.Count,
+                getWindowOrderName(this->m_RwTest.Order)
+                );
+
+        if (this->m_RwTest.Grid.nRows > 1)
+            gCatena.SafePrintf(
+                "Grid: %u ClockError x %u RxSyms values\n",
+                this->m_RwTest.Grid.nClockError,
+                this->m_RwTest.Grid.nRxSyms
+                );
 
         gCatena.SafePrintf(
-            "Rx triggered by digital input %d",
-            this->m_params.RxDigIn
+            "Rx triggered by digital input %d (%s)",
+            this->m_params.RxDigIn,
+            this->m_RwTest.DigIn.isInterrupt() ? "interrupt" : "polled"
             );
         if (this->m_RxDigOut.isEnabled())
             {
@@ -338,27 +585,84 @@ bool cTest::RwTest_t::begin(cTest &Test)
     {
     this->pTest = &Test;
     this->resetStats();
+    Test.m_RxCapture.reset();
     this->Count = Test.m_params.RxCount;
     this->WindowStart = us2osticks(Test.m_params.WindowStart);
     this->WindowStop = us2osticks(Test.m_params.WindowStop);
     this->WindowStep = us2osticks(Test.m_params.WindowStep);
+    this->Mode = Test.m_params.WindowModeKind;
     if (this->WindowStart <= 0 || this->WindowStop <= 0)
         {
         gCatena.SafePrintf("** please specify positive, non-zero param Window.Start and Window.Stop **\n");
         return false;
         }
-    if (this->WindowStep == 0)
+    if (this->Mode == WindowMode::Measure)
+        {
+        if (this->WindowStop <= this->WindowStart)
+            {
+            gCatena.SafePrintf("** measure mode: param Window.Stop must be after Window.Start **\n");
+            return false;
+            }
+        // the measure window ignores RxSyms and ClockError, so a grid
+        // over them would only repeat the same measurement.
+        if (Test.m_params.WindowRxSymsStep != 0 || Test.m_params.WindowClockErrorStep != 0.0f)
+            {
+            gCatena.SafePrintf("** measure mode: please set param Window.RxSyms and Window.ClockError to - **\n");
+            return false;
+            }
+        }
+    else if (this->WindowStep == 0)
         {
         gCatena.SafePrintf("** please specify a non-zero param Window.Step **\n");
         return false;
         }
+    this->Threshold = Test.m_params.WindowThreshold / 100.0f;
+    this->z = cStats::normalQuantile(Test.m_params.WindowConfidence / 100.0f);
+    this->Width = Test.m_params.WindowWidth / 100.0f;
+    this->Low = Test.m_params.WindowLow / 100.0f;
+    this->High = Test.m_params.WindowHigh / 100.0f;
+    if (this->Mode == WindowMode::Search)
+        {
+        // the search works on an ascending range, with Step as resolution.
+        if (this->WindowStop < this->WindowStart)
+            {
+            auto const t = this->WindowStart;
+            this->WindowStart = this->WindowStop;
+            this->WindowStop = t;
+            }
+        if (this->WindowStep < 0)
+            this->WindowStep = -this->WindowStep;
+        this->nSteps = 0;
+        }
+    else if (this->Mode == WindowMode::Measure)
+        this->nSteps = 0;
+    else
+        {
+        auto const n = (this->WindowStop - this->WindowStart) / this->WindowStep;
+        this->nSteps = n < 0 ? 1 : unsigned(n) + 1;
+        }
+    this->Order = this->Mode == WindowMode::Sweep ? Test.m_params.WindowOrderKind
+                                                  : WindowOrder::Sequential;
+    if (this->isInterleaved() && this->nSteps > kFitStepsMax)
+        {
+        gCatena.SafePrintf(
+            "** param Window.Order %s allows at most %u window steps **\n",
+            getWindowOrderName(this->Order),
+            kFitStepsMax
+            );
+        return false;
+        }
     this->DigIn.setInput(Test.m_params.RxDigIn, true);
     if (! this->DigIn.isEnabled())
         {
         gCatena.SafePrintf("** please set param Rx.DigIn to rx trigger input **\n");
         return false;
         }
+    this->nEdgesUsed = this->DigIn.getEdgeCount();
+    this->nMissed = this->nMissedTotal = 0;
+    this->nStale = this->nStaleTotal = this->nStaleRun = 0;
     Test.m_RxDigOut.setOutput(Test.m_params.RxDigOut, true);
+    this->gridBegin(Test.m_params);
 
     this->Fsm.init(*this, &RwTest_t::fsmDispatch);
     this->Fsm.eval();
@@ -387,45 +691,42 @@ cTest::RwTest_t::State cTest::RwTest_t::fsmDispatch(
         {
     case State::stInitial:
         this->fRunning = true;
-        this->Window = this->WindowStart;
         this->pTest->setupLMIC(this->pTest->m_params);
+        this->gridApply(this->pTest->m_params);
+        this->fitBegin();
+        this->Window = this->firstWindow();
 
         newState = State::stInitWindow;
         break;
 
     case State::stInitWindow:
-        if (fEntry)
+        if (fEntry && this->Mode == WindowMode::Measure)
+            this->measureWindow();
+        else if (fEntry)
             {
-            // calculate the time we'll use for the window. We have to
-            // first calculate the half-symbol time.  If bandwidth is 125*2^bw,
-            // and sf is 7..12, then hs (usec) is 128 << (sf-5-bw).
-            auto const sf = getSf(LMIC.rps);
-            ostime_t hsym;
-
-            if (sf == FSK)
-                hsym = us2osticksRound(80);
-            else
-                hsym = us2osticksRound(
-                                128 << ((sf - SF7 + 7) -
-                                        this->pTest->m_params.Bandwidth - 5)
-                                );
+            // calculate the time we'll use for the window, from the
+            // half-symbol time.
+            ostime_t const hsym =
+                cAirtime::symbolTiming(getSf(LMIC.rps), getBw(LMIC.rps)).halfSymbolTicks;
 
             this->WindowAdjust =
                 LMICcore_adjustForDrift(
                     this->Window,
                     hsym,
-                    LMICbandplan_MINRX_SYMS_LoRa_ClassA
+                    this->RxSymsIn
                     );
 
-            gCatena.SafePrintf(
-                "Window %ld us: adjusted %ld us, hsym %ld (%ld us) rxsyms %u (%ld us)\n",
-                (long)osticks2us(this->Window),
-                (long)osticks2us(this->WindowAdjust),
-                (long)hsym,
-                (long)osticks2us(hsym),
-                LMIC.rxsyms,
-                (long)osticks2us(LMIC.rxsyms * hsym * 2)
-                );
+            // interleaved sweeps print the windows at the end.
+            if (! this->isInterleaved())
+                gCatena.SafePrintf(
+                    "Window %ld us: adjusted %ld us, hsym %ld (%ld us) rxsyms %u (%ld us)\n",
+                    (long)osticks2us(this->Window),
+                    (long)osticks2us(this->WindowAdjust),
+                    (long)hsym,
+                    (long)osticks2us(hsym),
+                    LMIC.rxsyms,
+                    (long)osticks2us(LMIC.rxsyms * hsym * 2)
+                    );
             }
 
         newState = State::stWaitForTrigger;
@@ -434,19 +735,49 @@ cTest::RwTest_t::State cTest::RwTest_t::fsmDispatch(
     case State::stWaitForTrigger:
         if (fEntry)
             {
-            // nothing.
+            // any edges that came during the last try were missed; only
+            // an edge from now on will do. Count first: an edge between
+            // the two calls is then dropped by arm() and counted as
+            // missed next time, rather than counted as used twice.
+            this->countMissed();
+            this->DigIn.arm();
             }
 
         if (this->pTest->m_fStopTest)
             newState = State::stFinal;
         else if (this->DigIn.poll(this->tEdge))
+            {
+            ++this->nEdgesUsed;
             newState = State::stWaitForWindow;
+            }
         break;
 
     case State::stWaitForWindow:
         if (fEntry)
             {
             LMIC.rxtime = this->tEdge + this->WindowAdjust;
+
+            // if the edge was seen too late to open the window on time,
+            // the try would be misleading; discard it.
+            if (os_getTime() - (LMIC.rxtime - os_getRadioRxRampup()) > 0)
+                {
+                ++this->nStale;
+                ++this->nStaleTotal;
+                gCatena.SafePrintf("!");
+                if (++this->nStaleRun < this->Count)
+                    newState = State::stWaitForTrigger;
+                else
+                    {
+                    gCatena.SafePrintf(
+                        "\n** %lu stale triggers in a row at window %ld us: stopping **\n",
+                        (unsigned long) this->nStaleRun,
+                        (long) osticks2us(this->Window)
+                        );
+                    newState = State::stFinal;
+                    }
+                break;
+                }
+            this->nStaleRun = 0;
             }
 
         if (this->pTest->m_fStopTest)
@@ -465,9 +796,20 @@ cTest::RwTest_t::State cTest::RwTest_t::fsmDispatch(
                     gTest.m_RwTest.fRxComplete = true;
                     };
 
-            // start the transmit
+            // start the receive
             this->fRxComplete = false;
-            os_radio(RADIO_RX);
+            this->fRxStartSeen = false;
+            this->tTarget = LMIC.rxtime;
+            this->tIssue = os_getTime();
+            this->pTest->startRadio(RADIO_RX);
+
+            // if the LMIC didn't log the start, the radio has been
+            // opened by the time os_radio() returns.
+            if (! this->fRxStartSeen)
+                this->tRxStart = os_getTime();
+            this->recordLatency();
+            if (getSf(LMIC.rps) != FSK)
+                cRadio::enableRxDiagIrqs();
             }
 
         if (this->pTest->m_fStopTest)
@@ -486,51 +828,84 @@ cTest::RwTest_t::State cTest::RwTest_t::fsmDispatch(
             bool fDone;
 
             // accumulate stats.
+            auto const result = cTest::classifyRx();
+
             ++this->nTries;
-            if (LMIC.dataLen != 0)
+            this->Results.count(result);
+            if (LMIC.dataLen > 0)
+                this->pTest->m_RxCapture.put(result);
+            if (result == RxResult::Good)
                 {
                 ++this->nGood;
-                gCatena.SafePrintf("+");
+                if (this->Mode == WindowMode::Measure)
+                    this->measureRecord();
                 }
-            else
+            gCatena.SafePrintf("%c", getRxResultChar(result));
+
+            if (this->isInterleaved())
                 {
-                gCatena.SafePrintf("-");
+                // one try per visit: tally it against its window, and
+                // move on.
+                this->fitRecord();
+                fDone = ! this->interleaveNext();
                 }
-            fDone = false;
-            if (this->nTries >= this->Count)
+            else if (this->isProbeDone())
                 {
+                bool const fGood = this->isProbeGood();
+
                 // print
-                gCatena.SafePrintf("\nwindow %6u: received %u/%u\n",
+                gCatena.SafePrintf("\nwindow %6u: received %u/%u",
                     osticks2us(this->Window),
                     this->nGood,
                     this->nTries
                     );
-
-                // accumulate stats
-                this->nGoodTotal += this->nGood;
-                this->nTriesTotal += this->nTries;
-
-                this->nGood = this->nTries = 0;
+                this->Results.print();
+                if (this->Mode == WindowMode::Search)
+                    gCatena.SafePrintf(": %s", fGood ? "good" : "bad");
+                gCatena.SafePrintf("\n");
+                this->printTriggers();
+                this->printLatency(this->IssueLead, this->RxLate);
+                this->IssueLead.reset();
+                this->RxLate.reset();
+                this->gridRecord(this->stepIndex(), this->nGood, this->nTries);
+                this->fitRecord();
 
                 // go to next window value.
-                this->Window += this->WindowStep;
+                fDone = ! this->nextWindow(fGood);
+                }
+            else
+                {
+                // start next receive using current window.
+                newState = State::stWaitForTrigger;
+                break;
+                }
 
-                // check whether we're done.
-                if (this->WindowStep >= 0)
-                    fDone = (this->Window > this->WindowStop);
-                else
-                    fDone = (this->Window < this->WindowStop);
+            // accumulate stats
+            this->nGoodTotal += this->nGood;
+            this->nTriesTotal += this->nTries;
+            this->ResultsTotal.accumulate(this->Results);
 
-                // Do the appropriate state transition.
-                if (fDone)
-                    newState = State::stFinal;
-                else
-                    newState = State::stInitWindow;
+            this->nGood = this->nTries = 0;
+            this->Results.reset();
+
+            // at the end of a row, go to the next grid point.
+            if (fDone && this->Grid.iRow + 1 < this->Grid.nRows)
+                {
+                this->printRowResult();
+                if (this->gridNext())
+                    {
+                    this->gridApply(this->pTest->m_params);
+                    this->fitBegin();
+                    this->Window = this->firstWindow();
+                    fDone = false;
+                    }
                 }
 
-            // otherwise, start next receive using current window.
+            // Do the appropriate state transition.
+            if (fDone)
+                newState = State::stFinal;
             else
-                newState = State::stWaitForTrigger;
+                newState = State::stInitWindow;
             }
         break;
 
@@ -544,10 +919,24 @@ cTest::RwTest_t::State cTest::RwTest_t::fsmDispatch(
             this->fRunning = false;
             this->nGoodTotal += this->nGood;
             this->nTriesTotal += this->nTries;
-            gCatena.SafePrintf("total: received %u/%u\n",
+            this->ResultsTotal.accumulate(this->Results);
+            this->printRowResult();
+            this->countMissed();
+            gCatena.SafePrintf("total: received %u/%u",
                 this->nGoodTotal,
                 this->nTriesTotal
                 );
+            this->ResultsTotal.print();
+            gCatena.SafePrintf("\n");
+            if (this->nMissedTotal != 0 || this->nStaleTotal != 0)
+                gCatena.SafePrintf(
+                    "total triggers: %lu missed, %lu stale (discarded)\n",
+                    (unsigned long) this->nMissedTotal,
+                    (unsigned long) this->nStaleTotal
+                    );
+            this->printLatency(this->IssueLeadTotal, this->RxLateTotal);
+            this->gridNext();
+            this->gridPrint();
             }
         break;
         }
@@ -555,6 +944,62 @@ cTest::RwTest_t::State cTest::RwTest_t::fsmDispatch(
     return newState;
     }
 
+void cTest::RwTest_t::countMissed()
+    {
+    auto const nEdges = this->DigIn.getEdgeCount();
+    auto const nMissed = nEdges - this->nEdgesUsed;
+
+    this->nMissed += nMissed;
+    this->nMissedTotal += nMissed;
+    this->nEdgesUsed = nEdges;
+    }
+
+void cTest::RwTest_t::printTriggers()
+    {
+    if (this->nMissed != 0 || this->nStale != 0)
+        gCatena.SafePrintf(
+            "  triggers: %lu missed, %lu stale (discarded)\n",
+            (unsigned long) this->nMissed,
+            (unsigned long) this->nStale
+            );
+
+    this->nMissed = this->nStale = 0;
+    }
+
+// The scheduling error of each try is split in two: how early the
+// FSM called os_radio() relative to the target LMIC.rxtime (which must
+// cover the radio's rx ramp-up), and how late the radio actually opened.
+// Lateness is firmware scheduling error, not the DUT's RF timing.
+void cTest::RwTest_t::recordLatency()
+    {
+    float const issueLead = float(osticks2us(this->tTarget - this->tIssue));
+    float const rxLate = float(osticks2us(this->tRxStart - this->tTarget));
+
+    this->IssueLead.add(issueLead);
+    this->IssueLeadTotal.add(issueLead);
+    this->RxLate.add(rxLate);
+    this->RxLateTotal.add(rxLate);
+    }
+
+void cTest::RwTest_t::printLatency(
+    const cRunningStats &issueLead,
+    const cRunningStats &rxLate
+    ) const
+    {
+    if (rxLate.getCount() == 0)
+        return;
+
+    gCatena.SafePrintf(
+        "  rx issued %ld us early (min %ld us); rx start late mean %ld us, min %ld us, max %ld us, stddev %ld us\n",
+        long(issueLead.getMean()),
+        long(issueLead.getMin()),
+        long(rxLate.getMean()),
+        long(rxLate.getMin()),
+        long(rxLate.getMax()),
+        long(rxLate.getStdDev())
+        );
+    }
+
 bool cTest::handleLmicEvent(const char *pMessage)
     {
     if (pMessage == nullptr)
@@ -570,9 +1015,17 @@ bool cTest::handleLmicEvent(const char *pMessage)
     else if (pMessage[0] == '+')
         {
         if (pMessage[1] == 'R')
+            {
             this->m_RxDigOut.on();
+            this->m_RwTest.tRxStart = os_getTime();
+            this->m_RwTest.fRxStartSeen = true;
+            }
         else if (pMessage[1] == 'T')
+            {
             this->m_TxDigOut.on();
+            this->m_Tx.tStart = os_getTime();
+            this->m_Tx.fStartSeen = true;
+            }
 
         return true;
         }
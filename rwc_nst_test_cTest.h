@@ -22,8 +22,12 @@ Author:
 #include <cstdint>
 #include <Catena_PollableInterface.h>
 #include <Catena_FSM.h>
+#include <Catena_CommandStream.h>
 #include <arduino_lmic.h>
 #include <lmic/lorabase.h>
+#include "rwc_nst_test_dutycycle.h"
+#include "rwc_nst_test_radio.h"
+#include "rwc_nst_test_stats.h"
 
 /****************************************************************************\
 |
@@ -38,13 +42,18 @@ class cTest : public McciCatena::cPollableObject
 private:
     static constexpr std::uint32_t kRxTimeoutMsDefault      = 5000;
     static constexpr std::uint32_t kTxIntervalMsDefault     = 2000;
+    static constexpr std::uint32_t kTxAutoGuardUsDefault    = 2000;
     static constexpr std::uint32_t kTxPulseMsDefault        = 100;
     static constexpr std::uint32_t kTxGuardUsDefault        = 1000;
     static constexpr std::uint32_t kTxStartUsDefault        = 50;
+    static constexpr std::uint32_t kTxCarrierMsDefault      = 0;    // until canceled
     static constexpr std::uint32_t kRxRssiIntervalUsDefault = 0;    // LBT disabled
     static constexpr unsigned kTxTestCountDefault           = 3;
     static constexpr std::uint32_t kDefaultFreq             = 902300000;
     static constexpr float kDefaultClockError               = 0.0;  // 0 percent, no error
+    static constexpr float kRxPerTargetDefault              = 0.0;  // sequential PER test disabled
+    static constexpr float kRxPerConfidenceDefault          = 95.0; // percent
+    static constexpr std::uint32_t kRxPerIntervalMsDefault  = 0;
     static constexpr std::uint32_t kRxCountDefault          = 10;
     static constexpr ostime_t kWindowStartDefault           = 990 * 1000;
     static constexpr ostime_t kWindowStopDefault            = 1010 * 1000;
@@ -59,19 +68,127 @@ private:
     static constexpr std::int8_t kRxDigOutDefault           = -1;
     static constexpr std::int8_t kTxDigOutDefault           = -1;
     static constexpr std::int8_t kTxPulseOutDefault         = -1;
+    static constexpr bool kTxLedDefault                     = true;
+    static constexpr std::uint8_t kTxLengthDefault          = 4;
+    static constexpr std::int16_t kTxSeqOffsetDefault       = -1;   // no sequence counter
+    static constexpr std::int16_t kTxTimeOffsetDefault      = -1;   // no timestamp
+    static constexpr std::uint32_t kSweepCountDefault       = 10;
+    static constexpr std::uint16_t kPreambleDefault         = 8;
+    static constexpr std::uint8_t kImplicitLengthDefault    = 0;    // explicit header
+    static constexpr bool kCrcDefault                       = true;
+    static constexpr std::uint8_t kSyncWordDefault          = 0x34; // LoRaWAN public
+    static constexpr float kDutyCycleLimitDefault           = 0.0;  // no limit
+    static constexpr std::uint32_t kDutyCycleWindowDefault  = 3600; // seconds
+    static constexpr float kWindowThresholdDefault          = 50.0; // percent
+    static constexpr float kWindowConfidenceDefault         = 95.0; // percent
+    static constexpr float kWindowWidthDefault              = 0.0;  // fixed RxCount tries per step
+    static constexpr float kWindowLowDefault                = 10.0; // percent
+    static constexpr float kWindowHighDefault               = 90.0; // percent
+    static constexpr std::uint32_t kWindowSeedDefault       = 1;
+
+public:
+    // TxInterval value meaning "pace at airtime plus TxAutoGuardUs"; the
+    // parser rejects it as a number, so 0 still means back to back.
+    static constexpr std::uint32_t kTxIntervalAuto          = UINT32_MAX;
+
+    // maximum length of the user-supplied hex pattern
+    static constexpr unsigned kTxHexMax                     = 32;
+
+    // maximum number of frequencies in a sweep list
+    static constexpr unsigned kSweepFreqMax                 = 6;
+
+    // the LoRa sync words the tester can be set to match
+    static constexpr std::uint8_t kSyncWordPrivate          = 0x12;
+    static constexpr std::uint8_t kSyncWordPublic           = 0x34;
+
+    // shortest preamble the SX127x supports
+    static constexpr std::uint16_t kPreambleMin             = 6;
+
+    // payload generators for tx tests
+    enum class TxPattern : std::uint8_t
+        {
+        Hex,        // user-supplied pattern (param TxHex), repeated
+        Prbs9,      // x^9 + x^5 + 1
+        Prbs15,     // x^15 + x^14 + 1
+        Incr,       // 0, 1, 2, ...
+        };
+
+    // what to do when a transmit would exceed the duty-cycle limit
+    enum class DutyCycleMode : std::uint8_t
+        {
+        Throttle,   // delay the transmit until it fits
+        Report,     // send anyway, and count it
+        };
+
+    // how the rx window test chooses window values
+    enum class WindowMode : std::uint8_t
+        {
+        Sweep,      // Window.Start to Window.Stop by Window.Step
+        Search,     // bisect for the early and late edges
+        Measure,    // one long window; time each frame's arrival
+        };
+
+    static constexpr const char *getWindowModeName(WindowMode m)
+        {
+        return
+            m == WindowMode::Sweep      ? "sweep" :
+            m == WindowMode::Search     ? "search" :
+            m == WindowMode::Measure    ? "measure" :
+                                          "<<unknown>>";
+        }
+
+    // the order in which an rx window sweep visits window values
+    enum class WindowOrder : std::uint8_t
+        {
+        Sequential, // all tries at one window, then the next
+        Interleave, // one try at each window per round, in order
+        Shuffle,    // one try at each window per round, shuffled
+        };
+
+    static constexpr const char *getWindowOrderName(WindowOrder o)
+        {
+        return
+            o == WindowOrder::Sequential    ? "sequential" :
+            o == WindowOrder::Interleave    ? "interleave" :
+            o == WindowOrder::Shuffle       ? "shuffle" :
+                                              "<<unknown>>";
+        }
+
+    static constexpr const char *getDutyCycleModeName(DutyCycleMode m)
+        {
+        return
+            m == DutyCycleMode::Throttle    ? "throttle" :
+            m == DutyCycleMode::Report      ? "report" :
+                                              "<<unknown>>";
+        }
+
+    static constexpr const char *getTxPatternName(TxPattern p)
+        {
+        return
+            p == TxPattern::Hex     ? "hex" :
+            p == TxPattern::Prbs9   ? "prbs9" :
+            p == TxPattern::Prbs15  ? "prbs15" :
+            p == TxPattern::Incr    ? "incr" :
+                                      "<<unknown>>";
+        }
 
 public:
     struct Params
         {
         std::uint32_t   RxTimeout;
         std::uint32_t   TxInterval;
+        std::uint32_t   TxAutoGuardUs;
         std::uint32_t   TxPulseMs;
         std::uint32_t   TxGuardUs;
         std::uint32_t   TxStartUs;
+        std::uint32_t   TxCarrierMs;
         std::uint32_t   RxRssiIntervalUs;
         std::uint32_t   TxTestCount;
         std::uint32_t   Freq;
         float           ClockError;
+        float           RxPerTarget;
+        float           RxPerConfidence;
+        std::uint32_t   RxPerInterval;
         std::uint32_t   RxCount;
         ostime_t        WindowStart;
         ostime_t        WindowStop;
@@ -86,19 +203,72 @@ public:
         std::int8_t     RxDigOut;
         std::int8_t     TxDigOut;
         std::int8_t     TxPulseOut;
+        bool            TxLed;
+        std::uint8_t    TxLength;
+        TxPattern       TxPatternKind;
+        std::int16_t    TxSeqOffset;
+        std::int16_t    TxTimeOffset;
+        std::uint8_t    TxHexLen;
+        std::uint8_t    TxHex[kTxHexMax];
+        // sweep plan: a list of SweepFreqN frequencies, or (if
+        // SweepFreqStep is non-zero) SweepFreq[0]..SweepFreq[1].
+        // SweepFreqN == 0 means use Freq.
+        std::uint32_t   SweepFreq[kSweepFreqMax];
+        std::uint32_t   SweepFreqStep;
+        std::uint8_t    SweepFreqN;
+        // SweepPowerStep == 0 means use TxPower.
+        std::int8_t     SweepPowerLo;
+        std::int8_t     SweepPowerHi;
+        std::uint8_t    SweepPowerStep;
+        // bit (1 << sf_t); zero means use SpreadingFactor.
+        std::uint8_t    SweepSfMask;
+        std::uint32_t   SweepCount;
+        // LoRa radio profile
+        std::uint16_t   Preamble;
+        std::uint8_t    ImplicitLength;
+        bool            Crc;
+        std::uint8_t    SyncWord;
+        // duty-cycle accounting
+        float           DutyCycleLimit;
+        std::uint32_t   DutyCycleWindow;
+        DutyCycleMode   DutyCycleModeKind;
+        // rx window test mode, and the success rate that defines an edge
+        WindowMode      WindowModeKind;
+        float           WindowThreshold;
+        float           WindowConfidence;
+        // sweep early stop: interval width, and the rates beyond which
+        // a step is settled
+        float           WindowWidth;
+        float           WindowLow;
+        float           WindowHigh;
+        // rx window test grid; step zero means use RxSyms or ClockError.
+        std::uint16_t   WindowRxSymsLo;
+        std::uint16_t   WindowRxSymsHi;
+        std::uint8_t    WindowRxSymsStep;
+        float           WindowClockErrorLo;
+        float           WindowClockErrorHi;
+        float           WindowClockErrorStep;
+        // rx window sweep order, and the shuffle seed
+        WindowOrder     WindowOrderKind;
+        std::uint32_t   WindowSeed;
         };
 
     enum class ParamKey : std::uint8_t
         {
         RxTimeout,
         TxInterval,
+        TxAutoGuardUs,
         TxPulseMs,
         TxGuardUs,
         TxStartUs,
+        TxCarrierMs,
         RxRssiIntervalUs,
         TxTestCount,
         Freq,
         ClockError,
+        RxPerTarget,
+        RxPerConfidence,
+        RxPerInterval,
         RxCount,
         WindowStart,
         WindowStop,
@@ -113,6 +283,33 @@ public:
         RxDigOut,
         TxDigOut,
         TxPulseOut,
+        TxLed,
+        TxLength,
+        TxPatternKind,
+        TxSeqOffset,
+        TxTimeOffset,
+        TxHex,
+        SweepFreq,
+        SweepPower,
+        SweepSf,
+        SweepCount,
+        Preamble,
+        ImplicitLength,
+        Crc,
+        SyncWord,
+        DutyCycleLimit,
+        DutyCycleWindow,
+        DutyCycleModeKind,
+        WindowModeKind,
+        WindowThreshold,
+        WindowConfidence,
+        WindowWidth,
+        WindowLow,
+        WindowHigh,
+        WindowRxSyms,
+        WindowClockError,
+        WindowOrderKind,
+        WindowSeed,
         Max
         };
 
@@ -144,6 +341,53 @@ public:
         kInfo       = 1 << 3,
         };
 
+    // classification of a completed receive
+    enum class RxResult : std::uint8_t
+        {
+        Good,           // packet received, CRC ok
+        CrcError,       // packet received, payload CRC failed
+        Timeout,        // no packet (includes header errors)
+        Max
+        };
+
+    static constexpr char getRxResultChar(RxResult r)
+        {
+        return
+            r == RxResult::Good         ? '+' :
+            r == RxResult::CrcError     ? 'c' :
+                                          '-' ;
+        }
+
+    // per-class receive counters
+    struct RxResultCounts_t
+        {
+        std::uint32_t   n[unsigned(RxResult::Max)];
+
+        void reset()
+            {
+            for (auto &c : this->n)
+                c = 0;
+            }
+        void count(RxResult r)
+            {
+            ++this->n[unsigned(r)];
+            }
+        std::uint32_t get(RxResult r) const
+            {
+            return this->n[unsigned(r)];
+            }
+        void accumulate(const RxResultCounts_t &other)
+            {
+            for (unsigned i = 0; i < unsigned(RxResult::Max); ++i)
+                this->n[i] += other.n[i];
+            }
+        // print ", crc %u, timeout %u"
+        void print() const;
+        };
+
+    // classify the most recent receive from the radio IRQ flags.
+    static RxResult classifyRx();
+
 private:
     static constexpr Params kDefaultParams()
         {
@@ -151,13 +395,18 @@ private:
             {
             .RxTimeout = kRxTimeoutMsDefault,
             .TxInterval = kTxIntervalMsDefault,
+            .TxAutoGuardUs = kTxAutoGuardUsDefault,
             .TxPulseMs = kTxPulseMsDefault,
             .TxGuardUs = kTxGuardUsDefault,
             .TxStartUs = kTxStartUsDefault,
+            .TxCarrierMs = kTxCarrierMsDefault,
             .RxRssiIntervalUs = kRxRssiIntervalUsDefault,
             .TxTestCount = kTxTestCountDefault,
             .Freq = kDefaultFreq,
             .ClockError = kDefaultClockError,
+            .RxPerTarget = kRxPerTargetDefault,
+            .RxPerConfidence = kRxPerConfidenceDefault,
+            .RxPerInterval = kRxPerIntervalMsDefault,
             .RxCount = kRxCountDefault,
             .WindowStart = kWindowStartDefault,
             .WindowStop = kWindowStopDefault,
@@ -172,6 +421,42 @@ private:
             .RxDigOut = kRxDigOutDefault,
             .TxDigOut = kTxDigOutDefault,
             .TxPulseOut = kTxPulseOutDefault,
+            .TxLed = kTxLedDefault,
+            .TxLength = kTxLengthDefault,
+            .TxPatternKind = TxPattern::Hex,
+            .TxSeqOffset = kTxSeqOffsetDefault,
+            .TxTimeOffset = kTxTimeOffsetDefault,
+            .TxHexLen = 4,
+            .TxHex = { 0xCA, 0xFE, 0xF0, 0x0D },
+            .SweepFreq = { 0 },
+            .SweepFreqStep = 0,
+            .SweepFreqN = 0,
+            .SweepPowerLo = 0,
+            .SweepPowerHi = 0,
+            .SweepPowerStep = 0,
+            .SweepSfMask = 0,
+            .SweepCount = kSweepCountDefault,
+            .Preamble = kPreambleDefault,
+            .ImplicitLength = kImplicitLengthDefault,
+            .Crc = kCrcDefault,
+            .SyncWord = kSyncWordDefault,
+            .DutyCycleLimit = kDutyCycleLimitDefault,
+            .DutyCycleWindow = kDutyCycleWindowDefault,
+            .DutyCycleModeKind = DutyCycleMode::Throttle,
+            .WindowModeKind = WindowMode::Sweep,
+            .WindowThreshold = kWindowThresholdDefault,
+            .WindowConfidence = kWindowConfidenceDefault,
+            .WindowWidth = kWindowWidthDefault,
+            .WindowLow = kWindowLowDefault,
+            .WindowHigh = kWindowHighDefault,
+            .WindowRxSymsLo = 0,
+            .WindowRxSymsHi = 0,
+            .WindowRxSymsStep = 0,
+            .WindowClockErrorLo = 0.0f,
+            .WindowClockErrorHi = 0.0f,
+            .WindowClockErrorStep = 0.0f,
+            .WindowOrderKind = WindowOrder::Sequential,
+            .WindowSeed = kWindowSeedDefault,
             };
         };
 
@@ -194,6 +479,9 @@ public:
         stRxTest,       // running the Rx test
         stRxWindowTest, // running the Rx window test
         stTxWindowTest, // running the Tx window test
+        stTxBurstTest,  // running the Tx burst test
+        stTxCarrierTest, // running a CW or preamble-only transmission
+        stSweepTest,    // running the Tx sweep
 
         stFinal,        // this name must be present, it's the terminal state.
         };
@@ -205,6 +493,10 @@ public:
         StartRx,     // request to start RX test
         StartRxWindow, // request to start RX window test
         StartTxWindow, // request to start TX window test
+        StartTxBurst,  // request to start TX burst test
+        StartTxCw,     // request to start CW carrier
+        StartTxPreamble, // request to start continuous LoRa preamble
+        StartSweep,    // request to start TX sweep
         };
 
     static constexpr const char *getStateName(State s)
@@ -217,6 +509,9 @@ public:
             s == State::stRxTest        ? "stRxTest" :
             s == State::stRxWindowTest  ? "stRxWindowTest" :
             s == State::stTxWindowTest  ? "stTxWindowTest" :
+            s == State::stTxBurstTest   ? "stTxBurstTest" :
+            s == State::stTxCarrierTest ? "stTxCarrierTest" :
+            s == State::stSweepTest     ? "stSweepTest" :
             s == State::stFinal         ? "stFinal" :
                                           "<<unknown>>";
         }
@@ -236,6 +531,10 @@ public:
     bool evSendStartTx() { return this->evSendCommand(Command::StartTx); }
     bool evSendStartRxWindow() { return this->evSendCommand(Command::StartRxWindow); }
     bool evSendStartTxWindow() { return this->evSendCommand(Command::StartTxWindow); }
+    bool evSendStartTxBurst() { return this->evSendCommand(Command::StartTxBurst); }
+    bool evSendStartTxCw() { return this->evSendCommand(Command::StartTxCw); }
+    bool evSendStartTxPreamble() { return this->evSendCommand(Command::StartTxPreamble); }
+    bool evSendStartSweep() { return this->evSendCommand(Command::StartSweep); }
 
     // request an operation
     bool evSendCommand(Command cmd)
@@ -270,6 +569,83 @@ public:
     // process LMIC trace messages for GPIO control
     bool handleLmicEvent(const char *pMessage);
 
+    //-----------------
+    // Received-packet capture
+    //-----------------
+    class cRxCapture
+        {
+    public:
+        // number of packets retained
+        static constexpr unsigned kEntries = 32;
+        // number of payload bytes retained per packet
+        static constexpr unsigned kBytes = 16;
+
+        struct Entry_t
+            {
+            ostime_t        time;       // rx-complete time
+            std::int16_t    rssi;       // dB
+            std::int8_t     snr4;       // SNR * 4
+            std::uint8_t    len;        // full received length
+            RxResult        result;     // classification
+            std::uint8_t    data[kBytes]; // the first bytes of the payload
+            };
+
+        cRxCapture() {};
+
+        // discard all entries.
+        void reset()
+            {
+            this->m_head = this->m_n = 0;
+            this->m_nTotal = 0;
+            }
+
+        // record the packet in LMIC.frame; the oldest entry is overwritten
+        // when the ring is full.
+        void put(RxResult result);
+
+        // number of entries retained
+        unsigned getCount() const
+            {
+            return this->m_n;
+            }
+
+        // number of packets offered since reset
+        std::uint32_t getTotal() const
+            {
+            return this->m_nTotal;
+            }
+
+        // dump the ring, oldest first.
+        void printText(McciCatena::cCommandStream *pThis) const;
+        void writeBinary(McciCatena::cCommandStream *pThis) const;
+
+    private:
+        const Entry_t &getEntry(unsigned i) const
+            {
+            unsigned iEntry = this->m_head + kEntries - this->m_n + i;
+            return this->m_ring[iEntry % kEntries];
+            }
+
+        Entry_t         m_ring[kEntries];
+        unsigned        m_head = 0;
+        unsigned        m_n = 0;
+        std::uint32_t   m_nTotal = 0;
+        };
+
+    const cRxCapture &getRxCapture() const
+        {
+        return this->m_RxCapture;
+        }
+
+    // print the current duty-cycle utilization.
+    void dutyCyclePrintStatus();
+    // discard the duty-cycle history.
+    void dutyCycleReset()
+        {
+        this->m_DutyCycle.reset();
+        this->m_DutyCycleOver = 0;
+        }
+
     //-----------------
     // Output handling
     //-----------------
@@ -331,6 +707,12 @@ public:
     //-----------------
     // Input handling
     //-----------------
+    // Digital trigger input. If the pin has an interrupt, edges are
+    // captured by an ISR, so the time stamp doesn't carry the poll-loop
+    // latency; otherwise, the pin is polled. Only one instance can use
+    // the interrupt at a time. With an interrupt, every active edge is
+    // counted, even when nobody is waiting for one; when polled, edges
+    // are only seen by poll() and arm(), and several look like one.
     class cDigIn
         {
     public:
@@ -338,6 +720,7 @@ public:
 
         void setInput(int8_t pin, bool fActive)
             {
+            this->detach();
             if (pin >= 0)
                 {
                 pinMode(pin, INPUT);
@@ -345,6 +728,8 @@ public:
             this->m_pin = pin;
             this->m_fActive = fActive;
             this->m_last = digitalRead(pin);
+            this->m_nEdges = 0;
+            this->attach();
             }
 
         bool isEnabled() const
@@ -352,6 +737,12 @@ public:
             return this->m_pin >= 0;
             }
 
+        // true if edges are captured by interrupt.
+        bool isInterrupt() const
+            {
+            return this->m_irq >= 0;
+            }
+
         bool get() const
             {
             if (this->isEnabled())
@@ -361,32 +752,38 @@ public:
             }
 
         // check for an edge
-        bool poll(ostime_t &edgeTime)
-            {
-            const bool lastValue = this->m_last;
-            bool thisValue = digitalRead(this->m_pin);
+        bool poll(ostime_t &edgeTime);
 
-            if (lastValue != thisValue)
-                {
-                // save the change.
-                this->m_last = thisValue;
+        // start waiting for a new edge: edges that arrived earlier
+        // won't be returned by poll().
+        void arm();
 
-                // rising edge?
-                if (thisValue == this->m_fActive)
-                    {
-                    edgeTime = os_getTime();
-                    return true;
-                    }
-                }
-
-            // no edge seen.
-            return false;
+        // the number of active edges seen since setInput().
+        std::uint32_t getEdgeCount() const
+            {
+            return this->m_nEdges;
             }
 
     private:
+        void attach();
+        void detach();
+        static void isr();
+        // polled: check for a new active edge, and count it.
+        bool sample();
+
+        // the instance that owns the interrupt.
+        static cDigIn *s_pIsrInstance;
+
         int8_t m_pin = -1;
         bool m_fActive = true;
         bool m_last;
+        // interrupt number, or -1 if polled.
+        int m_irq = -1;
+        // set by isr(): micros() at the last active edge.
+        volatile bool m_fEdge;
+        volatile std::uint32_t m_edgeMicros;
+        // active edges seen
+        volatile std::uint32_t m_nEdges;
         };
 
 
@@ -408,14 +805,63 @@ private:
     bool rxTest(bool fEntry);
     // stop the rx test.
     void rxTestStop();
+    // evaluate the sequential PER test; true when decided.
+    bool rxPerEval(ostime_t now);
+    // print the rx test summary statistics.
+    void rxTestPrintStats() const;
+    // track the spacing between good packets for the rx test.
+    void rxRecordSpacing();
+    // take one noise-floor sample for the rx test.
+    void rxSampleNoise();
     // run a receive window test; return true when done
     bool rxWindowTest(bool fEntry);
     // run a transmit window test; return true when done
     bool txWindowTest(bool fEntry);
+    // run a transmit burst test; return true when done
+    bool txBurstTest(bool fEntry);
+    // print the burst test summary.
+    void txBurstPrintStats() const;
+    // run a CW or preamble-only transmission; return true when done
+    bool txCarrierTest(bool fEntry);
+    // (re)start the carrier for txCarrierTest()
+    void txCarrierStart();
+    // run a transmit sweep; return true when done
+    bool sweepTest(bool fEntry);
     // set up LMIC from Params
     void setupLMIC(const Params &params);
+    // start an os_radio() operation with the LoRa profile (preamble, sync word) applied
+    void startRadio(std::uint8_t mode);
+    // set the LMIC clock error from a percentage
+    static void setClockError(float percent);
+    // the LMIC radio parameters for Params
+    static rps_t getRps(const Params &params);
+    // time on air of one tx test frame, from Params
+    static std::uint32_t getTxAirtimeUs(const Params &params);
+    // the interval between tx test frames, resolving "auto"
+    static ostime_t getTxIntervalTicks(const Params &params);
+
+    // print the tx test summary statistics.
+    void txTestPrintStats();
+    // reset the on-air duration statistics for a new test.
+    void txOnAirReset();
+    // record the on-air duration of the frame that just completed.
+    void txOnAirRecord();
+    // time to wait before sending airtimeUs more, if throttling.
+    ostime_t dutyCycleDelay(std::uint32_t airtimeUs);
+    // false (with a message) if throttling can never send a frame of airtimeUs.
+    bool dutyCycleCheck(std::uint32_t airtimeUs) const;
+    // account for a transmit of airtimeUs that started at tStart.
+    void dutyCycleRecord(ostime_t tStart, std::uint32_t airtimeUs);
+    // the airtime allowed in the duty-cycle window (us); 0 if no limit.
+    std::uint32_t getDutyCycleBudgetUs() const;
+    // generate m_Tx.Data from the payload params; false if invalid.
+    bool buildTxPayload();
+    // patch the sequence counter and timestamp into LMIC.frame.
+    void patchTxPayload(std::uint32_t seq, ostime_t tStart) const;
 
     static osjobcbfn_t txTestDone;
+    static osjobcbfn_t txBurstDone;
+    static osjobcbfn_t txCarrierDone;
 
     //------------------------------------
     // the various operating properties
@@ -435,14 +881,69 @@ private:
     cDigOut     m_TxDigOut;
     cDigOut     m_RxDigOut;
 
+    // airtime accounting across all transmit tests
+    cDutyCycle  m_DutyCycle;
+    // number of transmits that went over the limit
+    std::uint32_t m_DutyCycleOver = 0;
+
     struct Tx_t
         {
         // transmission down-counter.
         std::uint32_t Count;
-        // time of last transmission
+        // scheduled start of next transmission
         ostime_t    Tnext;
+        // scheduled start of current transmission
+        ostime_t    tScheduled;
+        // actual start of current transmission
+        ostime_t    tStart;
+        // time to wake up before a scheduled transmission
+        ostime_t    tGuard;
+        // radio startup calibration time
+        ostime_t    tStartup;
+        // actual minus target keying time (tScheduled - tStartup) (us)
+        cRunningStats StartError;
+        // computed time on air of one frame (us)
+        std::uint32_t AirtimeUs;
+        // measured (start to tx-done) minus computed time on air (us)
+        cRunningStats OnAirError;
         bool        fContinuous: 1;
         bool        fIdle: 1;
+        // set by handleLmicEvent() when the LMIC logs tx start.
+        bool        fStartSeen: 1;
+        // TxInterval 0: no grid, each frame starts as soon as possible
+        bool        fBackToBack: 1;
+        // number of frames sent so far (the embedded sequence number)
+        std::uint32_t nSent;
+
+        // burst test measurements
+        struct Burst_t
+            {
+            // when the first frame was issued
+            ostime_t        tFirst;
+            // when the current frame was issued
+            ostime_t        tIssue;
+            // tx-done time of the previous frame
+            ostime_t        tLastDone;
+            // issue to tx-done (us)
+            cRunningStats   Latency;
+            // tx-done to next issue (us)
+            cRunningStats   Gap;
+            } Burst;
+
+        // CW and preamble-only transmissions
+        struct Carrier_t
+            {
+            // when the carrier was first turned on
+            ostime_t        tFirst;
+            // true for CW, false for LoRa preamble
+            bool            fCw: 1;
+            // true if param TxCarrierMs limits the run
+            bool            fTimed: 1;
+            // number of times the preamble had to be restarted
+            std::uint32_t   nRestart;
+            // FSK registers to restore after CW
+            cRadio::CwSave_t CwSave;
+            } Carrier;
         std::uint8_t nData;
         std::uint8_t Data[255];
         };
@@ -456,11 +957,54 @@ private:
         bool        fContinuous: 1;
         bool        fTimedOut: 1;
         bool        fReceiving: 1;
+        bool        fSeenGood: 1;
         osjob_t     TimeoutJob;
+        // per-class counts
+        RxResultCounts_t Results;
+        // frequency error estimates of good LoRa packets (Hz)
+        cRunningStats   FreqError;
+        // noise floor samples taken between packets (dB)
+        cRunningStats   NoiseFloor;
+        // peak RSSI seen in any noise sample (dB)
+        std::int16_t    NoisePeak;
+        // shortest noise sample taken, after limiting to the packet gap
+        ostime_t        NoiseTicksMin;
+        // end of the last good packet, and the shortest spacing seen
+        // between good packets (0 until known)
+        ostime_t        tLastGood;
+        ostime_t        tSpacing;
+
+        // the sequential PER test
+        struct Per_t
+            {
+            // generator packet interval
+            ostime_t        tInterval;
+            // time of the first received packet
+            ostime_t        tFirst;
+            // normal quantile for the requested confidence
+            float           z;
+            // target PER, as a fraction
+            float           Target;
+            // number of packet slots evaluated
+            std::uint32_t   nSlots;
+            // the PER bounds at the last evaluation
+            float           Lower;
+            float           Upper;
+            // true if the test is enabled
+            bool            fEnabled: 1;
+            // true once the first packet has been seen
+            bool            fStarted: 1;
+            // true once pass/fail is decided
+            bool            fDecided: 1;
+            // true if the decision was "pass"
+            bool            fPass: 1;
+            } Per;
         };
 
     Rx_t        m_Rx;
 
+    cRxCapture  m_RxCapture;
+
     class RwTest_t
         {
     private:
@@ -496,11 +1040,210 @@ private:
         std::uint32_t nTriesTotal;
         // how many successes in total
         std::uint32_t nGoodTotal;
+        // per-class results at this window
+        RxResultCounts_t Results;
+        // per-class results in total
+        RxResultCounts_t ResultsTotal;
+
+        // timing of the current try: the trigger is tEdge, the target
+        // is LMIC.rxtime.
+        ostime_t    tTarget;
+        // when os_radio(RADIO_RX) was called
+        ostime_t    tIssue;
+        // when the LMIC logged the rx start ('+R')
+        ostime_t    tRxStart;
+        bool        fRxStartSeen;
+        // how early os_radio() was called (tTarget - tIssue), in us,
+        // at this window and in total
+        cRunningStats IssueLead;
+        cRunningStats IssueLeadTotal;
+        // how late the radio opened (tRxStart - tTarget), in us
+        cRunningStats RxLate;
+        cRunningStats RxLateTotal;
 
         void resetStats()
             {
             this->nTries = this->nGood = this->nTriesTotal = this->nGoodTotal = 0;
+            this->Results.reset();
+            this->ResultsTotal.reset();
+            this->IssueLead.reset();
+            this->IssueLeadTotal.reset();
+            this->RxLate.reset();
+            this->RxLateTotal.reset();
+            this->Offset.reset();
+            }
+
+        // trigger accounting: edges consumed by tries (a baseline for
+        // DigIn.getEdgeCount()); triggers missed because they came
+        // during a try, and tries discarded because their trigger was
+        // seen too late to open the window on time, since the last
+        // report and in total; and stale tries in a row.
+        std::uint32_t nEdgesUsed;
+        std::uint32_t nMissed;
+        std::uint32_t nMissedTotal;
+        std::uint32_t nStale;
+        std::uint32_t nStaleTotal;
+        std::uint32_t nStaleRun;
+
+        // measure mode: frame arrival relative to the trigger (us).
+        static constexpr std::uint32_t kMeasureRxSymsMax = 1023;
+        cRunningStats Offset;
+
+        // measure mode: set up the long window.
+        void measureWindow();
+        // measure mode: record the arrival of the frame just received.
+        void measureRecord();
+        // measure mode: print and reset the arrival statistics.
+        void printMeasureResult();
+
+        // count the triggers that arrived since the last one used.
+        void countMissed();
+        // print and reset the trigger counts since the last report.
+        void printTriggers();
+
+        // record the timing of the try just made.
+        void recordLatency();
+        // print scheduling latency statistics.
+        void printLatency(const cRunningStats &issueLead, const cRunningStats &rxLate) const;
+
+        // the window mode for this run
+        WindowMode  Mode;
+        // success rate (fraction) that separates good from bad windows
+        float       Threshold;
+        // normal quantile for param Window.Confidence
+        float       z;
+        // sweep early stop (fractions); Width zero means disabled
+        float       Width;
+        float       Low;
+        float       High;
+
+        // edge search state (Window.Mode search)
+        struct Search_t
+            {
+            enum class Phase : std::uint8_t
+                {
+                Center,     // probing the middle of the range
+                Early,      // bisecting for the early edge
+                Late,       // bisecting for the late edge
+                Done,
+                };
+
+            Phase       phase;
+            // the bracket: outcomes at lo and hi differ
+            ostime_t    lo;
+            ostime_t    hi;
+            // the first probe, which must be good
+            ostime_t    Center;
+            // the located edges
+            ostime_t    Early;
+            ostime_t    Late;
+            // true if a failing window was seen on that side
+            bool        fEarlyBracketed: 1;
+            bool        fLateBracketed: 1;
+            // true if the center was good, so the edges are valid
+            bool        fValid: 1;
+            // number of window values probed
+            unsigned    nProbes;
+            } Search;
+
+        // the grid over RxSyms and ClockError (params Window.RxSyms and
+        // Window.ClockError); each row runs a whole sweep or search.
+        static constexpr unsigned kGridRowsMax = 16;
+        static constexpr unsigned kGridColsMax = 32;
+        static constexpr std::uint8_t kGridNoData = 0xFF;
+
+        struct Grid_t
+            {
+            unsigned    nRxSyms;
+            unsigned    nClockError;
+            unsigned    iRxSyms;
+            unsigned    iClockError;
+            // the current row, iClockError * nRxSyms + iRxSyms
+            unsigned    iRow;
+            unsigned    nRows;
+            // false if the grid is too large to tabulate
+            bool        fTable;
+            // the current point
+            rxsyms_t    RxSyms;
+            float       ClockError;
+            // sweep mode: success rate (%) at each window value
+            std::uint8_t Percent[kGridRowsMax][kGridColsMax];
+            // search mode: the edges found in each row
+            Search_t    Edges[kGridRowsMax];
+            } Grid;
+
+        // sweep mode: the number of window values in a sweep, and the
+        // tallies at each (so the edges can be fitted), in sweep order.
+        static constexpr unsigned kFitStepsMax = 64;
+        unsigned    nSteps;
+
+        struct FitStep_t
+            {
+            ostime_t        Adjust;
+            std::uint32_t   nGood;
+            std::uint32_t   nTries;
+            } FitSteps[kFitStepsMax];
+
+        // index of Window in a sweep, or -1.
+        int stepIndex() const;
+        // clear the sweep tallies.
+        void fitBegin();
+        // add the tries just made to the tallies for this window.
+        void fitRecord();
+        // fit the 10/50/90% edges and print them.
+        void fitPrint() const;
+
+        // the sweep order for this run (Sequential in search mode)
+        WindowOrder Order;
+        // interleaved sweeps: this round's order of steps, the position
+        // in it, and the shuffle generator state.
+        std::uint8_t StepOrder[kFitStepsMax];
+        unsigned    iOrder;
+        unsigned    iRound;
+        std::uint32_t Random;
+
+        bool isInterleaved() const
+            {
+            return this->Order != WindowOrder::Sequential;
+            }
+        // start a round of an interleaved sweep.
+        void startRound();
+        // pick the next window of an interleaved sweep; false when
+        // every step is settled.
+        bool interleaveNext();
+        // print the per-step results of an interleaved sweep.
+        void interleavePrint();
+        // print the results of one sweep or search.
+        void printRowResult();
+
+        // set up the grid for a run.
+        void gridBegin(const Params &params);
+        // apply the current grid point to the LMIC.
+        void gridApply(const Params &params);
+        // record the results at one window value.
+        void gridRecord(int col, std::uint32_t nGood, std::uint32_t nTries);
+        // advance to the next row; false at the end of the grid.
+        bool gridNext();
+        // print the grid table.
+        void gridPrint() const;
+
+        // the first window value to try.
+        ostime_t firstWindow();
+        // true when enough tries have been made at this window.
+        bool isProbeDone() const
+            {
+            return this->isStepDone(this->nGood, this->nTries);
             }
+        // true when nTries with nGood successes settle a window.
+        bool isStepDone(std::uint32_t nGood, std::uint32_t nTries) const;
+        // true if the tries at this window count as a success.
+        bool isProbeGood() const;
+        // advance Window after a probe; false when the run is done.
+        bool nextWindow(bool fGood);
+        // pick the next bisection probe; false when the search is done.
+        bool searchNext();
+        // print the edge search result.
+        void printSearchResult() const;
 
         // the digital input
         cDigIn      DigIn;
@@ -610,6 +1353,82 @@ private:
         };
 
     TwTest_t    m_TwTest;
+
+    class SweepTest_t
+        {
+    private:
+        // the container
+        cTest       *pTest;
+
+        // the plan, flattened at begin(); the point is
+        // (Sf[iSf], freq iFreq, power iPower), power varying fastest.
+        sf_t        Sf[SF12 + 1];
+        unsigned    nSf;
+        unsigned    nFreq;
+        unsigned    nPower;
+        unsigned    iSf;
+        unsigned    iFreq;
+        unsigned    iPower;
+        // point number, and number of points.
+        unsigned    iPoint;
+        unsigned    nPoints;
+
+        // the settings for the current point
+        Params      Point;
+        // computed time on air at this point (us)
+        std::uint32_t AirtimeUs;
+
+        // frames sent at this point
+        std::uint32_t   nSent;
+        // when the first frame at this point was issued
+        ostime_t    tFirst;
+        // when the current frame was issued
+        ostime_t    tIssue;
+        // tx-done time of the last frame
+        ostime_t    tLastDone;
+        // issue to tx-done (us)
+        cRunningStats   Latency;
+
+        // running?
+        bool        fRunning : 1;
+        // true if TX is done
+        bool        fTxComplete : 1;
+
+        // frequency of point iFreq
+        std::uint32_t getFreq(unsigned i) const;
+
+        // advance to the next point; false at end of plan.
+        bool nextPoint();
+
+        // print the record for the current point.
+        void printPoint() const;
+
+        // FSM
+    private:
+        enum class State : std::uint8_t
+            {
+            stNoChange = 0, // this name must be present: indicates "no change of state"
+            stInitial,      // this name must be present: it's the starting state.
+            stPoint,        // reconfigure for the next point.
+            stTx,           // sending frames at this point.
+            stFinal,        // this name must be present, it's the terminal state.
+            };
+
+        McciCatena::cFSM<SweepTest_t, State> Fsm;
+
+        // evaluate the control FSM.
+        State fsmDispatch(State currentState, bool fEntry);
+
+    public:
+        // called to initialize the test. false means
+        // couldn't start test.
+        bool begin(cTest &Test);
+
+        // called to advance the test; true when done.
+        bool poll();
+        };
+
+    SweepTest_t m_SweepTest;
     };
 
 #endif // _rwc_nst_test_cTest_h_
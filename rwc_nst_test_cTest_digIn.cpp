@@ -0,0 +1,129 @@
+/*
+
+Module:  rwc_nst_test_cTest_digIn.cpp
+
+Function:
+    cTest::cDigIn implementation
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+
+using namespace McciCatena;
+
+cTest::cDigIn *cTest::cDigIn::s_pIsrInstance;
+
+// The ISR only records micros(): the LMIC's os_getTime() keeps
+// unprotected overflow state and mustn't be called at interrupt time.
+// poll() converts the capture to ticks by backdating os_getTime() by
+// the elapsed microseconds, which is exact to within a tick.
+void cTest::cDigIn::isr()
+    {
+    auto const pThis = s_pIsrInstance;
+
+    if (pThis == nullptr)
+        return;
+
+    pThis->m_nEdges = pThis->m_nEdges + 1;
+    if (! pThis->m_fEdge)
+        {
+        pThis->m_edgeMicros = micros();
+        pThis->m_fEdge = true;
+        }
+    }
+
+void cTest::cDigIn::attach()
+    {
+    if (this->m_pin < 0)
+        return;
+
+    int const irq = digitalPinToInterrupt(this->m_pin);
+
+    // no interrupt on this pin, or it's already in use: poll.
+    if (irq < 0 || s_pIsrInstance != nullptr)
+        return;
+
+    this->m_fEdge = false;
+    this->m_irq = irq;
+    s_pIsrInstance = this;
+    attachInterrupt(irq, isr, this->m_fActive ? RISING : FALLING);
+    }
+
+void cTest::cDigIn::detach()
+    {
+    if (this->m_irq < 0)
+        return;
+
+    detachInterrupt(this->m_irq);
+    this->m_irq = -1;
+    s_pIsrInstance = nullptr;
+    }
+
+bool cTest::cDigIn::poll(ostime_t &edgeTime)
+    {
+    if (this->isInterrupt())
+        {
+        if (! this->m_fEdge)
+            return false;
+
+        // m_edgeMicros is stable until m_fEdge is cleared.
+        std::uint32_t const dt = micros() - this->m_edgeMicros;
+        ostime_t const tNow = os_getTime();
+
+        edgeTime = tNow - us2osticksRound(dt);
+        this->m_fEdge = false;
+        return true;
+        }
+
+    if (this->sample())
+        {
+        edgeTime = os_getTime();
+        return true;
+        }
+
+    // no edge seen.
+    return false;
+    }
+
+void cTest::cDigIn::arm()
+    {
+    if (this->isInterrupt())
+        {
+        // m_fEdge is only set by the ISR while it is false.
+        this->m_fEdge = false;
+        }
+    else
+        {
+        // pick up (and count) an edge that came while we weren't looking.
+        this->sample();
+        }
+    }
+
+bool cTest::cDigIn::sample()
+    {
+    const bool lastValue = this->m_last;
+    bool thisValue = digitalRead(this->m_pin);
+
+    if (lastValue != thisValue)
+        {
+        // save the change.
+        this->m_last = thisValue;
+
+        // rising edge?
+        if (thisValue == this->m_fActive)
+            {
+            this->m_nEdges = this->m_nEdges + 1;
+            return true;
+            }
+        }
+
+    return false;
+    }
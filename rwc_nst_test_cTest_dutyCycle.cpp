@@ -0,0 +1,109 @@
+/*
+
+Module:  rwc_nst_test_cTest_dutyCycle.cpp
+
+Function:
+    cTest duty-cycle accounting
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+
+std::uint32_t cTest::getDutyCycleBudgetUs() const
+    {
+    auto const &params = this->m_params;
+
+    if (params.DutyCycleLimit <= 0.0f)
+        return 0;
+
+    // percent of the window, in microseconds.
+    return std::uint32_t(params.DutyCycleLimit * params.DutyCycleWindow * 10000.0f);
+    }
+
+// All transmit tests call this before each frame; it only returns
+// non-zero in throttle mode with a limit set.
+ostime_t cTest::dutyCycleDelay(std::uint32_t airtimeUs)
+    {
+    auto const budgetUs = this->getDutyCycleBudgetUs();
+
+    if (budgetUs == 0 || this->m_params.DutyCycleModeKind != DutyCycleMode::Throttle)
+        return 0;
+
+    this->m_DutyCycle.begin(this->m_params.DutyCycleWindow);
+    return this->m_DutyCycle.getDelay(os_getTime(), airtimeUs, budgetUs);
+    }
+
+// In throttle mode, a frame longer than the whole budget never fits,
+// and dutyCycleDelay() would defer it forever; the transmit tests call
+// this before starting (and the sweep at each point) to refuse instead.
+bool cTest::dutyCycleCheck(std::uint32_t airtimeUs) const
+    {
+    auto const budgetUs = this->getDutyCycleBudgetUs();
+
+    if (budgetUs == 0 ||
+        this->m_params.DutyCycleModeKind != DutyCycleMode::Throttle ||
+        airtimeUs <= budgetUs)
+        return true;
+
+    gCatena.SafePrintf(
+        "** one frame (%lu us) exceeds the duty-cycle budget (%lu us): raise param DutyCycle.Limit or DutyCycle.Window **\n",
+        (unsigned long) airtimeUs,
+        (unsigned long) budgetUs
+        );
+    return false;
+    }
+
+// Airtime is always accounted, so the `duty` command can report
+// utilization even with no limit set.
+void cTest::dutyCycleRecord(ostime_t tStart, std::uint32_t airtimeUs)
+    {
+    auto const budgetUs = this->getDutyCycleBudgetUs();
+
+    this->m_DutyCycle.begin(this->m_params.DutyCycleWindow);
+    this->m_DutyCycle.add(tStart, airtimeUs);
+
+    if (budgetUs != 0 && this->m_DutyCycle.getUsedUs(tStart) > budgetUs)
+        ++this->m_DutyCycleOver;
+    }
+
+void cTest::dutyCyclePrintStatus()
+    {
+    auto const &params = this->m_params;
+
+    this->m_DutyCycle.begin(params.DutyCycleWindow);
+
+    auto const windowSec = this->m_DutyCycle.getWindowSec();
+    auto const usedUs = this->m_DutyCycle.getUsedUs(os_getTime());
+    // hundredths of a percent: used / (window * 1e6) * 1e4
+    auto const used = usedUs / (windowSec * 100);
+
+    gCatena.SafePrintf(
+        "Duty cycle: %lu.%02lu%% of %lu s window (%lu ms airtime), ",
+        (unsigned long) (used / 100),
+        (unsigned long) (used % 100),
+        (unsigned long) windowSec,
+        (unsigned long) (usedUs / 1000)
+        );
+
+    if (this->getDutyCycleBudgetUs() == 0)
+        gCatena.SafePrintf("no limit\n");
+    else
+        {
+        unsigned const limit = unsigned(params.DutyCycleLimit * 100.0f + 0.5f);
+
+        gCatena.SafePrintf(
+            "limit %u.%02u%% (%s), %lu transmits over limit\n",
+            limit / 100, limit % 100,
+            getDutyCycleModeName(params.DutyCycleModeKind),
+            (unsigned long) this->m_DutyCycleOver
+            );
+        }
+    }
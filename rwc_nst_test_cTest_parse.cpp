@@ -30,26 +30,58 @@ const cTest::ParamInfo_t cTest::ParamInfo[] =
     { ParamKey::Bandwidth,          "Bandwidth",          "125, 250, or 500 (kHz)" },
     { ParamKey::ClockError,         "ClockError",         "clock error (%)" },
     { ParamKey::CodingRate,         "CodingRate",         "coding rate (4/8, 5/8, 6/8, 7/8)" },
+    { ParamKey::Crc,                "Crc",                "LoRa payload CRC (0/1)" },
+    { ParamKey::DutyCycleLimit,     "DutyCycle.Limit",    "transmit duty-cycle limit (%), 0 for none" },
+    { ParamKey::DutyCycleModeKind,  "DutyCycle.Mode",     "over the duty-cycle limit: throttle or report" },
+    { ParamKey::DutyCycleWindow,    "DutyCycle.Window",   "duty-cycle window (1-3600 s)" },
     { ParamKey::Freq,               "Frequency",          "test frequency (Hz)" },
+    { ParamKey::ImplicitLength,     "ImplicitLength",     "LoRa implicit-header payload length, 0 for explicit header" },
     { ParamKey::RxRssiDbMax,        "LBT.dB",             "listen-before-talk maximum signal (dB)" },
-    { ParamKey::RxRssiIntervalUs,   "LBT.time",           "listen-before-talk measurement time (us)" },
+    { ParamKey::RxRssiIntervalUs,   "LBT.time",           "listen-before-talk and rx noise-floor measurement time (us)" },
+    { ParamKey::Preamble,           "Preamble",           "LoRa preamble length (6-65535 symbols)" },
     { ParamKey::RxCount,            "RxCount",            "receive window repeat count" },
     { ParamKey::RxDigIn,            "RxDigIn",            "digital input for rx window test" },
     { ParamKey::RxDigOut,           "RxDigOut",           "digital output to pulse during RX (pin)" },
+    { ParamKey::RxPerConfidence,    "RxPer.Confidence",   "rx PER test confidence level (%)" },
+    { ParamKey::RxPerInterval,      "RxPer.Interval",     "rx PER test generator packet interval (ms)" },
+    { ParamKey::RxPerTarget,        "RxPer.Target",       "rx PER test target PER (%), 0 to disable" },
     { ParamKey::RxSyms,             "RxSyms",             "packet preamble timeout (symbols)" },
     { ParamKey::RxTimeout,          "RxTimeout",          "receive timeout (ms)" },
     { ParamKey::SpreadingFactor,    "SpreadingFactor",    "7-12 or FSK" },
+    { ParamKey::SweepCount,         "Sweep.Count",        "sweep frames per point" },
+    { ParamKey::SweepFreq,          "Sweep.Freq",         "sweep frequencies (Hz): f1,f2,... or start:stop:step; - for Frequency" },
+    { ParamKey::SweepPower,         "Sweep.Power",        "sweep tx powers (dB): lo:hi[:step]; - for TxPower" },
+    { ParamKey::SweepSf,            "Sweep.SF",           "sweep spreading factors: list of 7-12 or FSK; - for SpreadingFactor" },
+    { ParamKey::SyncWord,           "SyncWord",           "LoRa sync word: 0x12 (private) or 0x34 (public)" },
+    { ParamKey::TxAutoGuardUs,      "TxAutoGuardUs",      "guard added to airtime for TxInterval auto (us)" },
+    { ParamKey::TxCarrierMs,        "TxCarrierMs",        "cw and txpre duration (ms), 0 to run until canceled" },
     { ParamKey::TxDigOut,           "TxDigOut",           "digital output to pulse during TX (pin)" },
     { ParamKey::TxGuardUs,          "TxGuardUs",          "transmit window guard time (usec)" },
-    { ParamKey::TxInterval,         "TxInterval",         "transmit interval (ms)" },
+    { ParamKey::TxHex,              "TxHex",              "tx payload pattern for TxPattern hex (up to 32 bytes of hex)" },
+    { ParamKey::TxInterval,         "TxInterval",         "transmit interval (ms), or auto to pace at airtime plus guard" },
+    { ParamKey::TxLed,              "TxLed",              "light LED_BUILTIN during tx test transmits (0/1)" },
+    { ParamKey::TxLength,           "TxLength",           "tx payload length (1 to LMIC frame limit, 64 by default)" },
+    { ParamKey::TxPatternKind,      "TxPattern",          "tx payload: hex, prbs9, prbs15 or incr" },
     { ParamKey::TxPower,            "TxPower",            "transmit power (dB)" },
     { ParamKey::TxPulseMs,          "TxPulseMs",          "transimt window pulse width (ms)" },
     { ParamKey::TxPulseOut,         "TxPulseOut",         "digital output to pulse for timing of TX window (pin)" },
+    { ParamKey::TxSeqOffset,        "TxSeqOffset",        "offset of 4-byte tx sequence number in payload, -1 for none" },
     { ParamKey::TxStartUs,          "TxStartUs",          "transmit window startup calibration time (usec)" },
     { ParamKey::TxTestCount,        "TxTestCount",        "transmit test repeat count" },
+    { ParamKey::TxTimeOffset,       "TxTimeOffset",       "offset of 4-byte tx timestamp (os ticks) in payload, -1 for none" },
+    { ParamKey::WindowClockError,   "Window.ClockError",  "rx window test clock errors (%): lo:hi:step; - for ClockError" },
+    { ParamKey::WindowConfidence,   "Window.Confidence",  "rx window search and early-stop confidence level (%)" },
+    { ParamKey::WindowHigh,         "Window.High",        "rx window sweep: stop a step once surely above this rate (%)" },
+    { ParamKey::WindowLow,          "Window.Low",         "rx window sweep: stop a step once surely below this rate (%)" },
+    { ParamKey::WindowModeKind,     "Window.Mode",        "rx window test: sweep, search for edges, or measure arrival" },
+    { ParamKey::WindowOrderKind,    "Window.Order",       "rx window sweep order: sequential, interleave or shuffle" },
+    { ParamKey::WindowRxSyms,       "Window.RxSyms",      "rx window test RxSyms values: lo:hi[:step]; - for RxSyms" },
+    { ParamKey::WindowSeed,         "Window.Seed",        "rx window shuffle seed" },
     { ParamKey::WindowStart,        "Window.Start",       "receive window start (us)" },
-    { ParamKey::WindowStep,         "Window.Step",        "receive window step (us)" },
+    { ParamKey::WindowStep,         "Window.Step",        "receive window step, or search resolution (us)" },
     { ParamKey::WindowStop,         "Window.Stop",        "receive window stop (us)" },
+    { ParamKey::WindowThreshold,    "Window.Threshold",   "rx window success rate that defines an edge (%)" },
+    { ParamKey::WindowWidth,        "Window.Width",       "rx window sweep: stop a step once the interval is this narrow (%), 0 to disable" },
     };
 
 bool cTest::getParam(const char *pKey, char *pBuf, size_t nBuf) const
@@ -63,6 +95,12 @@ bool cTest::getParam(const char *pKey, char *pBuf, size_t nBuf) const
     return false;
     }
 
+static void printPercent(char *pBuf, size_t nBuf, float value)
+    {
+    unsigned ppk = std_fabsf(value * 10.0f) + 0.5f;
+    McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u.%u%%", ppk / 10, ppk % 10);
+    }
+
 bool cTest::getParamByKey(cTest::ParamKey key, char *pBuf, size_t nBuf) const
     {
     bool fResult = true;
@@ -78,7 +116,18 @@ bool cTest::getParamByKey(cTest::ParamKey key, char *pBuf, size_t nBuf) const
         break;
 
     case ParamKey::TxInterval:
-        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.TxInterval);
+        if (this->m_params.TxInterval == kTxIntervalAuto)
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "auto");
+        else
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.TxInterval);
+        break;
+
+    case ParamKey::TxAutoGuardUs:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.TxAutoGuardUs);
+        break;
+
+    case ParamKey::TxCarrierMs:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.TxCarrierMs);
         break;
 
     case ParamKey::TxPulseMs:
@@ -106,10 +155,19 @@ bool cTest::getParamByKey(cTest::ParamKey key, char *pBuf, size_t nBuf) const
         break;
 
     case ParamKey::ClockError:
-        {
-        unsigned ceppk = std_fabsf(this->m_params.ClockError * 10.0f) + 0.5f;
-        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u.%u%%", ceppk / 10, ceppk % 10);
-        }
+        printPercent(pBuf, nBuf, this->m_params.ClockError);
+        break;
+
+    case ParamKey::RxPerTarget:
+        printPercent(pBuf, nBuf, this->m_params.RxPerTarget);
+        break;
+
+    case ParamKey::RxPerConfidence:
+        printPercent(pBuf, nBuf, this->m_params.RxPerConfidence);
+        break;
+
+    case ParamKey::RxPerInterval:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.RxPerInterval);
         break;
 
     case ParamKey::RxCount:
@@ -167,6 +225,194 @@ bool cTest::getParamByKey(cTest::ParamKey key, char *pBuf, size_t nBuf) const
         McciAdkLib_Snprintf(pBuf, nBuf, 0, "%d", this->m_params.TxPulseOut);
         break;
 
+    case ParamKey::TxLed:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", unsigned(this->m_params.TxLed));
+        break;
+
+    case ParamKey::TxLength:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.TxLength);
+        break;
+
+    case ParamKey::TxPatternKind:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%s", getTxPatternName(this->m_params.TxPatternKind));
+        break;
+
+    case ParamKey::TxSeqOffset:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%d", this->m_params.TxSeqOffset);
+        break;
+
+    case ParamKey::TxTimeOffset:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%d", this->m_params.TxTimeOffset);
+        break;
+
+    case ParamKey::TxHex:
+        if (nBuf < 2u * this->m_params.TxHexLen + 1)
+            fResult = false;
+        else
+            {
+            pBuf[0] = '\0';
+            for (unsigned i = 0; i < this->m_params.TxHexLen; ++i)
+                McciAdkLib_Snprintf(pBuf, nBuf, 2 * i, "%02X", this->m_params.TxHex[i]);
+            }
+        break;
+
+    case ParamKey::SweepFreq:
+        {
+        auto const &p = this->m_params;
+
+        if (p.SweepFreqN == 0)
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "-");
+        else if (p.SweepFreqStep != 0)
+            McciAdkLib_Snprintf(
+                pBuf, nBuf, 0, "%lu:%lu:%lu",
+                (unsigned long) p.SweepFreq[0],
+                (unsigned long) p.SweepFreq[1],
+                (unsigned long) p.SweepFreqStep
+                );
+        else
+            {
+            size_t n = 0;
+            pBuf[0] = '\0';
+            for (unsigned i = 0; i < p.SweepFreqN; ++i)
+                n = McciAdkLib_Snprintf(
+                        pBuf, nBuf, n, "%s%lu", i == 0 ? "" : ",", (unsigned long) p.SweepFreq[i]
+                        );
+            }
+        }
+        break;
+
+    case ParamKey::SweepPower:
+        if (this->m_params.SweepPowerStep == 0)
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "-");
+        else
+            McciAdkLib_Snprintf(
+                pBuf, nBuf, 0, "%d:%d:%u",
+                this->m_params.SweepPowerLo,
+                this->m_params.SweepPowerHi,
+                this->m_params.SweepPowerStep
+                );
+        break;
+
+    case ParamKey::SweepSf:
+        if (this->m_params.SweepSfMask == 0)
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "-");
+        else
+            {
+            size_t n = 0;
+            pBuf[0] = '\0';
+            for (unsigned sf = FSK; sf <= SF12; ++sf)
+                {
+                if (! (this->m_params.SweepSfMask & (1u << sf)))
+                    continue;
+                if (sf == FSK)
+                    n = McciAdkLib_Snprintf(pBuf, nBuf, n, "%sFSK", n == 0 ? "" : ",");
+                else
+                    n = McciAdkLib_Snprintf(pBuf, nBuf, n, "%s%u", n == 0 ? "" : ",", sf + 7 - SF7);
+                }
+            }
+        break;
+
+    case ParamKey::SweepCount:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.SweepCount);
+        break;
+
+    case ParamKey::Preamble:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.Preamble);
+        break;
+
+    case ParamKey::ImplicitLength:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.ImplicitLength);
+        break;
+
+    case ParamKey::Crc:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", unsigned(this->m_params.Crc));
+        break;
+
+    case ParamKey::SyncWord:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "0x%02x", this->m_params.SyncWord);
+        break;
+
+    case ParamKey::DutyCycleLimit:
+        printPercent(pBuf, nBuf, this->m_params.DutyCycleLimit);
+        break;
+
+    case ParamKey::DutyCycleWindow:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%u", this->m_params.DutyCycleWindow);
+        break;
+
+    case ParamKey::DutyCycleModeKind:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%s", getDutyCycleModeName(this->m_params.DutyCycleModeKind));
+        break;
+
+    case ParamKey::WindowModeKind:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%s", getWindowModeName(this->m_params.WindowModeKind));
+        break;
+
+    case ParamKey::WindowThreshold:
+        printPercent(pBuf, nBuf, this->m_params.WindowThreshold);
+        break;
+
+    case ParamKey::WindowConfidence:
+        printPercent(pBuf, nBuf, this->m_params.WindowConfidence);
+        break;
+
+    case ParamKey::WindowWidth:
+        printPercent(pBuf, nBuf, this->m_params.WindowWidth);
+        break;
+
+    case ParamKey::WindowLow:
+        printPercent(pBuf, nBuf, this->m_params.WindowLow);
+        break;
+
+    case ParamKey::WindowHigh:
+        printPercent(pBuf, nBuf, this->m_params.WindowHigh);
+        break;
+
+    case ParamKey::WindowOrderKind:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%s", getWindowOrderName(this->m_params.WindowOrderKind));
+        break;
+
+    case ParamKey::WindowSeed:
+        McciAdkLib_Snprintf(pBuf, nBuf, 0, "%lu", (unsigned long) this->m_params.WindowSeed);
+        break;
+
+    case ParamKey::WindowRxSyms:
+        if (this->m_params.WindowRxSymsStep == 0)
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "-");
+        else
+            McciAdkLib_Snprintf(
+                pBuf, nBuf, 0, "%u:%u:%u",
+                this->m_params.WindowRxSymsLo,
+                this->m_params.WindowRxSymsHi,
+                this->m_params.WindowRxSymsStep
+                );
+        break;
+
+    case ParamKey::WindowClockError:
+        if (this->m_params.WindowClockErrorStep == 0.0f)
+            McciAdkLib_Snprintf(pBuf, nBuf, 0, "-");
+        else
+            {
+            size_t n = 0;
+            float const v[] =
+                {
+                this->m_params.WindowClockErrorLo,
+                this->m_params.WindowClockErrorHi,
+                this->m_params.WindowClockErrorStep
+                };
+
+            for (auto const x : v)
+                {
+                unsigned ppk = std_fabsf(x * 10.0f) + 0.5f;
+                n = McciAdkLib_Snprintf(
+                        pBuf, nBuf, n, "%s%u.%u",
+                        n == 0 ? "" : ":", ppk / 10, ppk % 10
+                        );
+                }
+            McciAdkLib_Snprintf(pBuf, nBuf, n, "%%");
+            }
+        break;
+
     default:
         fResult = false;
         break;
@@ -234,6 +480,86 @@ static bool parseUnsignedPartial(
     return ! fOverflow;
     }
 
+// parse a percentage, with optional fraction and optional trailing '%'.
+static bool parsePercent(
+    const char *pValue,
+    size_t nValue,
+    float &result
+    )
+    {
+    bool fResult;
+    size_t nParsed;
+    std::uint32_t nonce;
+    float percent;
+
+    if (nValue > 0 && pValue[nValue-1] == '%')
+        --nValue;
+
+    if (nValue > 0 && pValue[0] == '.')
+        {
+        // only have a fraction
+        nParsed = 0;
+        nonce = 0;
+        fResult = true;
+        }
+    else
+        {
+        fResult = parseUnsignedPartial(pValue, nValue, nonce, nParsed);
+        }
+
+    if (fResult)
+        {
+        percent = nonce;
+        }
+
+    if (fResult && nParsed < nValue && pValue[nParsed] == '.')
+        {
+        // scan the fraction.
+        pValue += nParsed + 1;
+        nValue -= nParsed + 1;
+
+        if (nValue > 0)
+            {
+            fResult = parseUnsignedPartial(pValue, nValue, nonce, nParsed);
+            if (nParsed != nValue || nParsed > 6)
+                fResult = false;
+            else
+                {
+                unsigned adjust = 10;
+                for (auto i = nParsed - 1; i > 0; --i)
+                    adjust *= 10;
+                percent = (percent * adjust + nonce) / adjust;
+                }
+            }
+        }
+    else if (fResult && nParsed != nValue)
+        fResult = false;
+
+    if (fResult && ! (0.0f <= percent && percent <= 100.0))
+        fResult = false;
+
+    if (fResult)
+        result = percent;
+
+    return fResult;
+    }
+
+static bool parseBool(const char *pValue, bool &result)
+    {
+    if (strcmp(pValue, "1") == 0 ||
+        strcasecmp(pValue, "on") == 0 ||
+        strcasecmp(pValue, "true") == 0)
+        result = true;
+    else if (strcmp(pValue, "0") == 0 ||
+             strcasecmp(pValue, "off") == 0 ||
+             strcasecmp(pValue, "false") == 0)
+        result = false;
+    else
+        return false;
+
+    return true;
+    }
+
 static bool parse_int8(
     const char *pValue,
     size_t nValue,
@@ -300,6 +626,280 @@ static bool parse_int32(
     return fResult;
     }
 
+// parse a payload offset: -1 (none) or 0..254.
+static bool parseOffset(
+    const char *pValue,
+    size_t nValue,
+    std::int16_t &result
+    )
+    {
+    std::int32_t nonce;
+
+    if (! parse_int32(pValue, nValue, nonce))
+        return false;
+    if (! (-1 <= nonce && nonce < MAX_LEN_FRAME))
+        return false;
+
+    result = std::int16_t(nonce);
+    return true;
+    }
+
+// parse a string of hex digit pairs into bytes.
+static bool parseHexBytes(
+    const char *pValue,
+    size_t nValue,
+    std::uint8_t *pResult,
+    size_t nResult,
+    std::uint8_t &nBytes
+    )
+    {
+    auto const hexval = [](char c) -> int
+        {
+        return ('0' <= c && c <= '9') ? c - '0' :
+               ('a' <= c && c <= 'f') ? c - 'a' + 10 :
+               ('A' <= c && c <= 'F') ? c - 'A' + 10 :
+                                        -1;
+        };
+
+    if (nValue == 0 || (nValue & 1) != 0 || nValue / 2 > nResult)
+        return false;
+
+    for (size_t i = 0; i < nValue; ++i)
+        {
+        if (hexval(pValue[i]) < 0)
+            return false;
+        }
+
+    for (size_t i = 0; i < nValue / 2; ++i)
+        pResult[i] = std::uint8_t((hexval(pValue[2*i]) << 4) | hexval(pValue[2*i + 1]));
+
+    nBytes = std::uint8_t(nValue / 2);
+    return true;
+    }
+
+// return the length of the leading field of pValue, up to `sep`.
+static size_t fieldLength(const char *pValue, size_t nValue, char sep)
+    {
+    auto const p = (const char *) memchr(pValue, sep, nValue);
+
+    return p == nullptr ? nValue : p - pValue;
+    }
+
+// parse a sweep frequency plan: "-", "f1,f2,...", or "start:stop:step".
+static bool parseSweepFreq(
+    const char *pValue,
+    size_t nValue,
+    cTest::Params &params
+    )
+    {
+    std::uint32_t f[cTest::kSweepFreqMax];
+    unsigned n;
+
+    if (strcmp(pValue, "-") == 0)
+        {
+        params.SweepFreqN = 0;
+        params.SweepFreqStep = 0;
+        return true;
+        }
+
+    bool const fRange = fieldLength(pValue, nValue, ':') != nValue;
+    char const sep = fRange ? ':' : ',';
+
+    for (n = 0; nValue != 0; ++n)
+        {
+        size_t const nField = fieldLength(pValue, nValue, sep);
+
+        if (n == cTest::kSweepFreqMax || ! parseUnsigned(pValue, nField, f[n]))
+            return false;
+        if (nField == nValue)
+            nValue = 0;
+        else
+            {
+            pValue += nField + 1;
+            nValue -= nField + 1;
+            }
+        }
+
+    if (fRange)
+        {
+        if (! (n == 3 && f[0] <= f[1] && f[2] != 0))
+            return false;
+        params.SweepFreqStep = f[2];
+        n = 2;
+        }
+    else
+        params.SweepFreqStep = 0;
+
+    for (unsigned i = 0; i < n; ++i)
+        params.SweepFreq[i] = f[i];
+    params.SweepFreqN = std::uint8_t(n);
+    return true;
+    }
+
+// parse a sweep power plan: "-", "lo:hi", or "lo:hi:step".
+static bool parseSweepPower(
+    const char *pValue,
+    size_t nValue,
+    cTest::Params &params
+    )
+    {
+    std::int8_t lo, hi;
+    std::uint32_t step = 1;
+
+    if (strcmp(pValue, "-") == 0)
+        {
+        params.SweepPowerStep = 0;
+        return true;
+        }
+
+    size_t nField = fieldLength(pValue, nValue, ':');
+    if (nField == nValue || ! parse_int8(pValue, nField, lo))
+        return false;
+    pValue += nField + 1;
+    nValue -= nField + 1;
+
+    nField = fieldLength(pValue, nValue, ':');
+    if (! parse_int8(pValue, nField, hi))
+        return false;
+    if (nField != nValue)
+        {
+        pValue += nField + 1;
+        nValue -= nField + 1;
+        if (! (parseUnsigned(pValue, nValue, step) && step != 0 && step <= 0xFF))
+            return false;
+        }
+
+    if (lo > hi)
+        return false;
+
+    params.SweepPowerLo = lo;
+    params.SweepPowerHi = hi;
+    params.SweepPowerStep = std::uint8_t(step);
+    return true;
+    }
+
+// parse an rx window RxSyms range: "-", "lo:hi", or "lo:hi:step".
+static bool parseWindowRxSyms(
+    const char *pValue,
+    size_t nValue,
+    cTest::Params &params
+    )
+    {
+    std::uint16_t lo, hi;
+    std::uint32_t step = 1;
+
+    if (strcmp(pValue, "-") == 0)
+        {
+        params.WindowRxSymsStep = 0;
+        return true;
+        }
+
+    size_t nField = fieldLength(pValue, nValue, ':');
+    if (nField == nValue || ! parseUnsigned16(pValue, nField, lo))
+        return false;
+    pValue += nField + 1;
+    nValue -= nField + 1;
+
+    nField = fieldLength(pValue, nValue, ':');
+    if (! parseUnsigned16(pValue, nField, hi))
+        return false;
+    if (nField != nValue)
+        {
+        pValue += nField + 1;
+        nValue -= nField + 1;
+        if (! (parseUnsigned(pValue, nValue, step) && step != 0 && step <= 0xFF))
+            return false;
+        }
+
+    if (lo > hi)
+        return false;
+
+    params.WindowRxSymsLo = lo;
+    params.WindowRxSymsHi = hi;
+    params.WindowRxSymsStep = std::uint8_t(step);
+    return true;
+    }
+
+// parse an rx window clock error range: "-", or "lo:hi:step" (%).
+static bool parseWindowClockError(
+    const char *pValue,
+    size_t nValue,
+    cTest::Params &params
+    )
+    {
+    float v[3];
+
+    if (strcmp(pValue, "-") == 0)
+        {
+        params.WindowClockErrorStep = 0.0f;
+        return true;
+        }
+
+    for (unsigned i = 0; i < 3; ++i)
+        {
+        size_t const nField = fieldLength(pValue, nValue, ':');
+
+        if ((nField == nValue) != (i == 2) || ! parsePercent(pValue, nField, v[i]))
+            return false;
+        if (i < 2)
+            {
+            pValue += nField + 1;
+            nValue -= nField + 1;
+            }
+        }
+
+    if (! (v[0] <= v[1] && v[2] > 0.0f))
+        return false;
+
+    params.WindowClockErrorLo = v[0];
+    params.WindowClockErrorHi = v[1];
+    params.WindowClockErrorStep = v[2];
+    return true;
+    }
+
+// parse a list of spreading factors, "-", or "7,9,12,fsk".
+static bool parseSweepSf(
+    const char *pValue,
+    size_t nValue,
+    std::uint8_t &mask
+    )
+    {
+    std::uint8_t m = 0;
+
+    if (strcmp(pValue, "-") == 0)
+        {
+        mask = 0;
+        return true;
+        }
+
+    while (nValue != 0)
+        {
+        size_t const nField = fieldLength(pValue, nValue, ',');
+        std::uint32_t nonce;
+
+        if (nField == 3 && strncasecmp(pValue, "fsk", 3) == 0)
+            m |= 1u << FSK;
+        else if (parseUnsigned(pValue, nField, nonce) && 7 <= nonce && nonce <= 12)
+            m |= 1u << (nonce + (SF7 - 7));
+        else
+            return false;
+
+        if (nField == nValue)
+            nValue = 0;
+        else
+            {
+            pValue += nField + 1;
+            nValue -= nField + 1;
+            }
+        }
+
+    if (m == 0)
+        return false;
+
+    mask = m;
+    return true;
+    }
+
 bool cTest::setParamByKey(cTest::ParamKey key, const char *pValue)
     {
     bool fResult = true;
@@ -316,7 +916,28 @@ bool cTest::setParamByKey(cTest::ParamKey key, const char *pValue)
         break;
 
     case ParamKey::TxInterval:
-        fResult = parseUnsigned(pValue, nValue, this->m_params.TxInterval);
+        if (strcasecmp(pValue, "auto") == 0)
+            this->m_params.TxInterval = kTxIntervalAuto;
+        else
+            {
+            std::uint32_t nonce;
+
+            fResult = parseUnsigned(pValue, nValue, nonce);
+            if (! (fResult && nonce != kTxIntervalAuto))
+                {
+                fResult = false;
+                break;
+                }
+            this->m_params.TxInterval = nonce;
+            }
+        break;
+
+    case ParamKey::TxAutoGuardUs:
+        fResult = parseUnsigned(pValue, nValue, this->m_params.TxAutoGuardUs);
+        break;
+
+    case ParamKey::TxCarrierMs:
+        fResult = parseUnsigned(pValue, nValue, this->m_params.TxCarrierMs);
         break;
 
     case ParamKey::TxPulseMs:
@@ -344,58 +965,28 @@ bool cTest::setParamByKey(cTest::ParamKey key, const char *pValue)
         break;
 
     case ParamKey::ClockError:
-        {
-        size_t nParsed;
-        std::uint32_t nonce;
-        float clockError;
-
-        if (nValue > 0 && pValue[nValue-1] == '%')
-            --nValue;
-
-        if (nValue > 0 && pValue[0] == '.')
-            {
-            // only have a fraction
-            nParsed = 0;
-            nonce = 0;
-            fResult = true;
-            }
-        else
-            {
-            fResult = parseUnsignedPartial(pValue, nValue, nonce, nParsed);
-            }
-
-        if (fResult)
-            {
-            clockError = nonce;
-            }
+        fResult = parsePercent(pValue, nValue, this->m_params.ClockError);
+        break;
 
-        if (fResult && nParsed < nValue && pValue[nParsed] == '.')
-            {
-            // scan the fraction.
-            pValue += nParsed + 1;
-            nValue -= nParsed + 1;
+    case ParamKey::RxPerTarget:
+        fResult = parsePercent(pValue, nValue, this->m_params.RxPerTarget);
+        break;
 
-            if (nValue > 0)
-                {
-                fResult = parseUnsignedPartial(pValue, nValue, nonce, nParsed);
-                if (nParsed != nValue || nParsed > 6)
-                    fResult = false;
-                else
-                    {
-                    unsigned adjust = 10;
-                    for (auto i = nParsed - 1; i > 0; --i)
-                        adjust *= 10;
-                    clockError = (clockError * adjust + nonce) / adjust;
-                    }
-                }
-            }
+    case ParamKey::RxPerConfidence:
+        {
+        float confidence;
 
-        if (fResult && ! (0.0f <= clockError && clockError <= 100.0))
+        fResult = parsePercent(pValue, nValue, confidence);
+        if (fResult && ! (50.0f <= confidence && confidence < 100.0f))
             fResult = false;
+        if (fResult)
+            this->m_params.RxPerConfidence = confidence;
+        }
+        break;
 
-        this->m_params.ClockError = clockError;
+    case ParamKey::RxPerInterval:
+        fResult = parseUnsigned(pValue, nValue, this->m_params.RxPerInterval);
         break;
-        }
 
     case ParamKey::RxCount:
         fResult = parseUnsigned(pValue, nValue, this->m_params.RxCount);
@@ -498,6 +1089,263 @@ bool cTest::setParamByKey(cTest::ParamKey key, const char *pValue)
         fResult = parse_int8(pValue, nValue, this->m_params.TxPulseOut);
         break;
 
+    case ParamKey::TxLed:
+        fResult = parseBool(pValue, this->m_params.TxLed);
+        break;
+
+    case ParamKey::TxLength:
+        {
+        std::uint32_t nonce;
+
+        fResult = parseUnsigned(pValue, nValue, nonce);
+        if (! (fResult && 1 <= nonce && nonce <= MAX_LEN_FRAME))
+            {
+            fResult = false;
+            break;
+            }
+        this->m_params.TxLength = std::uint8_t(nonce);
+        }
+        break;
+
+    case ParamKey::TxPatternKind:
+        {
+        static const TxPattern kPatterns[] =
+            { TxPattern::Hex, TxPattern::Prbs9, TxPattern::Prbs15, TxPattern::Incr };
+
+        fResult = false;
+        for (auto p : kPatterns)
+            {
+            if (strcasecmp(pValue, getTxPatternName(p)) == 0)
+                {
+                this->m_params.TxPatternKind = p;
+                fResult = true;
+                break;
+                }
+            }
+        }
+        break;
+
+    case ParamKey::TxSeqOffset:
+        fResult = parseOffset(pValue, nValue, this->m_params.TxSeqOffset);
+        break;
+
+    case ParamKey::SweepFreq:
+        fResult = parseSweepFreq(pValue, nValue, this->m_params);
+        break;
+
+    case ParamKey::SweepPower:
+        fResult = parseSweepPower(pValue, nValue, this->m_params);
+        break;
+
+    case ParamKey::SweepSf:
+        fResult = parseSweepSf(pValue, nValue, this->m_params.SweepSfMask);
+        break;
+
+    case ParamKey::SweepCount:
+        fResult = parseUnsigned(pValue, nValue, this->m_params.SweepCount);
+        break;
+
+    case ParamKey::Preamble:
+        {
+        std::uint16_t nonce;
+
+        fResult = parseUnsigned16(pValue, nValue, nonce);
+        if (! (fResult && nonce >= kPreambleMin))
+            {
+            fResult = false;
+            break;
+            }
+        this->m_params.Preamble = nonce;
+        }
+        break;
+
+    case ParamKey::ImplicitLength:
+        {
+        std::uint32_t nonce;
+
+        fResult = parseUnsigned(pValue, nValue, nonce);
+        if (! (fResult && nonce <= MAX_LEN_FRAME))
+            {
+            fResult = false;
+            break;
+            }
+        this->m_params.ImplicitLength = std::uint8_t(nonce);
+        }
+        break;
+
+    case ParamKey::Crc:
+        fResult = parseBool(pValue, this->m_params.Crc);
+        break;
+
+    case ParamKey::SyncWord:
+        {
+        std::uint32_t nonce;
+        bool fOverflow = false;
+
+        if (nValue > 2 && pValue[0] == '0' && (pValue[1] == 'x' || pValue[1] == 'X'))
+            fResult = McciAdkLib_BufferToUint32(pValue + 2, nValue - 2, 16, &nonce, &fOverflow) == nValue - 2 &&
+                      ! fOverflow;
+        else
+            fResult = parseUnsigned(pValue, nValue, nonce);
+
+        // only the sync words the tester can match.
+        if (! (fResult && (nonce == kSyncWordPrivate || nonce == kSyncWordPublic)))
+            {
+            fResult = false;
+            break;
+            }
+        this->m_params.SyncWord = std::uint8_t(nonce);
+        }
+        break;
+
+    case ParamKey::DutyCycleLimit:
+        fResult = parsePercent(pValue, nValue, this->m_params.DutyCycleLimit);
+        break;
+
+    case ParamKey::DutyCycleWindow:
+        {
+        std::uint32_t nonce;
+
+        fResult = parseUnsigned(pValue, nValue, nonce);
+        if (! (fResult && 1 <= nonce && nonce <= cDutyCycle::kWindowSecMax))
+            {
+            fResult = false;
+            break;
+            }
+        this->m_params.DutyCycleWindow = nonce;
+        }
+        break;
+
+    case ParamKey::DutyCycleModeKind:
+        if (strcasecmp(pValue, getDutyCycleModeName(DutyCycleMode::Throttle)) == 0)
+            this->m_params.DutyCycleModeKind = DutyCycleMode::Throttle;
+        else if (strcasecmp(pValue, getDutyCycleModeName(DutyCycleMode::Report)) == 0)
+            this->m_params.DutyCycleModeKind = DutyCycleMode::Report;
+        else
+            fResult = false;
+        break;
+
+    case ParamKey::WindowModeKind:
+        {
+        static const WindowMode kModes[] =
+            { WindowMode::Sweep, WindowMode::Search, WindowMode::Measure };
+
+        fResult = false;
+        for (auto m : kModes)
+            {
+            if (strcasecmp(pValue, getWindowModeName(m)) == 0)
+                {
+                this->m_params.WindowModeKind = m;
+                fResult = true;
+                break;
+                }
+            }
+        }
+        break;
+
+    case ParamKey::WindowThreshold:
+        {
+        float threshold;
+
+        fResult = parsePercent(pValue, nValue, threshold);
+        if (fResult && ! (0.0f < threshold && threshold < 100.0f))
+            fResult = false;
+        if (fResult)
+            this->m_params.WindowThreshold = threshold;
+        }
+        break;
+
+    case ParamKey::WindowConfidence:
+        {
+        float confidence;
+
+        fResult = parsePercent(pValue, nValue, confidence);
+        if (fResult && ! (50.0f <= confidence && confidence < 100.0f))
+            fResult = false;
+        if (fResult)
+            this->m_params.WindowConfidence = confidence;
+        }
+        break;
+
+    case ParamKey::WindowWidth:
+        {
+        float width;
+
+        fResult = parsePercent(pValue, nValue, width);
+        if (fResult && ! (0.0f <= width && width < 100.0f))
+            fResult = false;
+        if (fResult)
+            this->m_params.WindowWidth = width;
+        }
+        break;
+
+    // Low and High must stay ordered: 0 < Low < High < 100.
+    case ParamKey::WindowLow:
+        {
+        float low;
+
+        fResult = parsePercent(pValue, nValue, low);
+        if (fResult && ! (0.0f < low && low < this->m_params.WindowHigh))
+            fResult = false;
+        if (fResult)
+            this->m_params.WindowLow = low;
+        }
+        break;
+
+    case ParamKey::WindowHigh:
+        {
+        float high;
+
+        fResult = parsePercent(pValue, nValue, high);
+        if (fResult && ! (this->m_params.WindowLow < high && high < 100.0f))
+            fResult = false;
+        if (fResult)
+            this->m_params.WindowHigh = high;
+        }
+        break;
+
+    case ParamKey::WindowRxSyms:
+        fResult = parseWindowRxSyms(pValue, nValue, this->m_params);
+        break;
+
+    case ParamKey::WindowOrderKind:
+        {
+        static const WindowOrder kOrders[] =
+            { WindowOrder::Sequential, WindowOrder::Interleave, WindowOrder::Shuffle };
+
+        fResult = false;
+        for (auto o : kOrders)
+            {
+            if (strcasecmp(pValue, getWindowOrderName(o)) == 0)
+                {
+                this->m_params.WindowOrderKind = o;
+                fResult = true;
+                break;
+                }
+            }
+        }
+        break;
+
+    case ParamKey::WindowSeed:
+        fResult = parseUnsigned(pValue, nValue, this->m_params.WindowSeed);
+        break;
+
+    case ParamKey::WindowClockError:
+        fResult = parseWindowClockError(pValue, nValue, this->m_params);
+        break;
+
+    case ParamKey::TxTimeOffset:
+        fResult = parseOffset(pValue, nValue, this->m_params.TxTimeOffset);
+        break;
+
+    case ParamKey::TxHex:
+        fResult = parseHexBytes(
+                    pValue, nValue,
+                    this->m_params.TxHex, sizeof(this->m_params.TxHex),
+                    this->m_params.TxHexLen
+                    );
+        break;
+
     default:
         fResult = false;
         break;
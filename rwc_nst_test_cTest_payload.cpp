@@ -0,0 +1,124 @@
+/*
+
+Module:  rwc_nst_test_cTest_payload.cpp
+
+Function:
+    cTest tx payload generator
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+
+// Generate a maximal-length PRBS, MSB first, from a Fibonacci LFSR of
+// `order` bits with feedback taps `order` and `tap`, seeded with all ones.
+static void fillPrbs(
+    std::uint8_t *pData,
+    unsigned nData,
+    unsigned order,
+    unsigned tap
+    )
+    {
+    std::uint32_t const mask = (std::uint32_t(1) << order) - 1;
+    std::uint32_t lfsr = mask;
+
+    for (unsigned i = 0; i < nData; ++i)
+        {
+        std::uint8_t b = 0;
+
+        for (unsigned j = 0; j < 8; ++j)
+            {
+            std::uint32_t const bit = ((lfsr >> (order - 1)) ^ (lfsr >> (tap - 1))) & 1u;
+
+            lfsr = ((lfsr << 1) | bit) & mask;
+            b = std::uint8_t((b << 1) | bit);
+            }
+
+        pData[i] = b;
+        }
+    }
+
+static void putBigEndian32(std::uint8_t *p, std::uint32_t v)
+    {
+    p[0] = std::uint8_t(v >> 24);
+    p[1] = std::uint8_t(v >> 16);
+    p[2] = std::uint8_t(v >> 8);
+    p[3] = std::uint8_t(v);
+    }
+
+// Build the payload for a tx test into m_Tx.Data. This is done once per
+// test; the transmit path only patches the sequence number and timestamp
+// (4 bytes each, big-endian) with patchTxPayload().
+bool cTest::buildTxPayload()
+    {
+    auto const &params = this->m_params;
+    unsigned const n = params.TxLength;
+
+    if (n == 0)
+        {
+        gCatena.SafePrintf("** please set param TxLength to 1..255 **\n");
+        return false;
+        }
+    if (params.ImplicitLength != 0 && params.ImplicitLength != n)
+        {
+        gCatena.SafePrintf("** param TxLength must equal ImplicitLength in implicit-header mode **\n");
+        return false;
+        }
+    if (params.TxSeqOffset >= 0 && unsigned(params.TxSeqOffset) + 4 > n)
+        {
+        gCatena.SafePrintf("** param TxSeqOffset + 4 must not exceed TxLength **\n");
+        return false;
+        }
+    if (params.TxTimeOffset >= 0 && unsigned(params.TxTimeOffset) + 4 > n)
+        {
+        gCatena.SafePrintf("** param TxTimeOffset + 4 must not exceed TxLength **\n");
+        return false;
+        }
+
+    switch (params.TxPatternKind)
+        {
+    case TxPattern::Prbs9:
+        fillPrbs(this->m_Tx.Data, n, 9, 5);
+        break;
+
+    case TxPattern::Prbs15:
+        fillPrbs(this->m_Tx.Data, n, 15, 14);
+        break;
+
+    case TxPattern::Incr:
+        for (unsigned i = 0; i < n; ++i)
+            this->m_Tx.Data[i] = std::uint8_t(i);
+        break;
+
+    case TxPattern::Hex:
+    default:
+        if (params.TxHexLen == 0)
+            {
+            gCatena.SafePrintf("** please set param TxHex **\n");
+            return false;
+            }
+        for (unsigned i = 0; i < n; ++i)
+            this->m_Tx.Data[i] = params.TxHex[i % params.TxHexLen];
+        break;
+        }
+
+    this->m_Tx.nData = std::uint8_t(n);
+    return true;
+    }
+
+void cTest::patchTxPayload(std::uint32_t seq, ostime_t tStart) const
+    {
+    auto const &params = this->m_params;
+
+    if (params.TxSeqOffset >= 0)
+        putBigEndian32(LMIC.frame + params.TxSeqOffset, seq);
+    if (params.TxTimeOffset >= 0)
+        putBigEndian32(LMIC.frame + params.TxTimeOffset, std::uint32_t(tStart));
+    }
@@ -0,0 +1,214 @@
+/*
+
+Module:  rwc_nst_test_cTest_rwFit.cpp
+
+Function:
+    Edge fitting for the rx window sweep (cTest::RwTest_t)
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+
+using namespace McciCatena;
+
+// At the end of a sweep, the good/total tallies of each step are reduced
+// on the device, replacing extra/filter-rw-log.sh and the spreadsheet.
+// Starting from the step with the best success rate, the sketch walks
+// outwards to the first step on each side that falls below 10, 50 and
+// 90%, and interpolates linearly between that step and its neighbor to
+// place the edge. An edge that doesn't fall before the end of the sweep
+// is reported at the last window value, marked '<' or '>'. The same
+// interpolation gives the adjusted window (the time the receiver was
+// actually scheduled), which is what filter-rw-log.sh calls "target".
+
+int cTest::RwTest_t::stepIndex() const
+    {
+    if (this->Mode != WindowMode::Sweep)
+        return -1;
+
+    auto const col = (this->Window - this->WindowStart) / this->WindowStep;
+
+    if (col < 0 || unsigned(col) >= this->nSteps)
+        return -1;
+
+    return int(col);
+    }
+
+void cTest::RwTest_t::fitBegin()
+    {
+    for (auto &s : this->FitSteps)
+        {
+        s.nGood = s.nTries = 0;
+        }
+    }
+
+void cTest::RwTest_t::fitRecord()
+    {
+    auto const col = this->stepIndex();
+
+    if (col < 0 || unsigned(col) >= kFitStepsMax)
+        return;
+
+    auto &s = this->FitSteps[col];
+
+    s.Adjust = this->WindowAdjust;
+    s.nGood += this->nGood;
+    s.nTries += this->nTries;
+    }
+
+// an interleaved sweep prints its steps at the end, in the same format
+// as a sequential sweep, so extra/filter-rw-log.sh still works.
+void cTest::RwTest_t::interleavePrint()
+    {
+    gCatena.SafePrintf("\n");
+    for (unsigned col = 0; col < this->nSteps; ++col)
+        {
+        auto const &s = this->FitSteps[col];
+
+        if (s.nTries == 0)
+            continue;
+
+        auto const window = this->WindowStart + ostime_t(col) * this->WindowStep;
+
+        gCatena.SafePrintf(
+            "Window %ld us: adjusted %ld us\n"
+            "window %6u: received %u/%u\n",
+            (long) osticks2us(window),
+            (long) osticks2us(s.Adjust),
+            osticks2us(window),
+            s.nGood,
+            s.nTries
+            );
+        this->gridRecord(int(col), s.nGood, s.nTries);
+        }
+
+    this->printTriggers();
+    this->printLatency(this->IssueLead, this->RxLate);
+    this->IssueLead.reset();
+    this->RxLate.reset();
+    }
+
+void cTest::RwTest_t::printRowResult()
+    {
+    if (this->Mode == WindowMode::Search)
+        this->printSearchResult();
+    else if (this->Mode == WindowMode::Measure)
+        this->printMeasureResult();
+    else
+        {
+        if (this->isInterleaved())
+            this->interleavePrint();
+        this->fitPrint();
+        }
+    }
+
+void cTest::RwTest_t::fitPrint() const
+    {
+    static constexpr std::uint8_t kLevels[] = { 10, 50, 90 };
+
+    if (this->nSteps > kFitStepsMax)
+        {
+        gCatena.SafePrintf("** too many window steps to fit edges (limit %u) **\n", kFitStepsMax);
+        return;
+        }
+
+    // the steps with data, in ascending window order.
+    std::uint8_t iStep[kFitStepsMax];
+    unsigned n = 0;
+
+    for (unsigned k = 0; k < this->nSteps; ++k)
+        {
+        unsigned const col = this->WindowStep > 0 ? k : this->nSteps - 1 - k;
+
+        if (this->FitSteps[col].nTries != 0)
+            iStep[n++] = std::uint8_t(col);
+        }
+
+    if (n == 0)
+        return;
+
+    auto const rate =
+        [this, &iStep](unsigned i) -> float
+            {
+            auto const &s = this->FitSteps[iStep[i]];
+            return float(s.nGood) / float(s.nTries);
+            };
+    auto const window =
+        [this, &iStep](unsigned i) -> float
+            {
+            return float(osticks2us(this->WindowStart + ostime_t(iStep[i]) * this->WindowStep));
+            };
+    auto const adjust =
+        [this, &iStep](unsigned i) -> float
+            {
+            return float(osticks2us(this->FitSteps[iStep[i]].Adjust));
+            };
+
+    unsigned peak = 0;
+    for (unsigned i = 1; i < n; ++i)
+        {
+        if (rate(i) > rate(peak))
+            peak = i;
+        }
+
+    gCatena.SafePrintf(
+        "Fit: peak %u%% at window %ld us\n",
+        unsigned(rate(peak) * 100.0f + 0.5f),
+        long(window(peak))
+        );
+
+    for (auto const pct : kLevels)
+        {
+        float const level = pct / 100.0f;
+
+        if (rate(peak) < level)
+            {
+            gCatena.SafePrintf("  %2u%%: not reached\n", pct);
+            continue;
+            }
+
+        // find the steps on either side that are at or above level; then
+        // interpolate toward the outside neighbors, if any.
+        unsigned lo = peak;
+        unsigned hi = peak;
+
+        while (lo > 0 && rate(lo - 1) >= level)
+            --lo;
+        while (hi + 1 < n && rate(hi + 1) >= level)
+            ++hi;
+
+        float early = window(lo), earlyAdj = adjust(lo);
+        float late = window(hi), lateAdj = adjust(hi);
+
+        if (lo > 0)
+            {
+            float const t = (level - rate(lo - 1)) / (rate(lo) - rate(lo - 1));
+            early = window(lo - 1) + t * (window(lo) - window(lo - 1));
+            earlyAdj = adjust(lo - 1) + t * (adjust(lo) - adjust(lo - 1));
+            }
+        if (hi + 1 < n)
+            {
+            float const t = (rate(hi) - level) / (rate(hi) - rate(hi + 1));
+            late = window(hi) + t * (window(hi + 1) - window(hi));
+            lateAdj = adjust(hi) + t * (adjust(hi + 1) - adjust(hi));
+            }
+
+        gCatena.SafePrintf(
+            "  %2u%%: early %ld%s us (adjusted %ld us), late %ld%s us (adjusted %ld us), width %ld us\n",
+            pct,
+            long(early + 0.5f), lo > 0 ? "" : "<",
+            long(earlyAdj + 0.5f),
+            long(late + 0.5f), hi + 1 < n ? "" : ">",
+            long(lateAdj + 0.5f),
+            long(late - early + 0.5f)
+            );
+        }
+    }
@@ -0,0 +1,195 @@
+/*
+
+Module:  rwc_nst_test_cTest_rwGrid.cpp
+
+Function:
+    RxSyms x ClockError grid for the rx window test (cTest::RwTest_t)
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+#include <cmath>
+
+using namespace McciCatena;
+
+// Each row of the grid is one (ClockError, RxSyms) point, with RxSyms
+// varying fastest; the window sweep or search runs in full for each
+// row. RxSyms is the symbol count passed to LMICcore_adjustForDrift(),
+// which widens it (and moves the window) according to the clock error,
+// just as the LMIC does for a class A window. The results are kept
+// as a compact table: the success rate at each window value in sweep
+// mode, or the edges in search mode.
+
+void cTest::RwTest_t::gridBegin(const Params &params)
+    {
+    auto &g = this->Grid;
+
+    if (params.WindowRxSymsStep == 0)
+        g.nRxSyms = 1;
+    else
+        g.nRxSyms = (params.WindowRxSymsHi - params.WindowRxSymsLo) / params.WindowRxSymsStep + 1;
+
+    if (params.WindowClockErrorStep == 0.0f)
+        g.nClockError = 1;
+    else
+        g.nClockError = unsigned(
+                            (params.WindowClockErrorHi - params.WindowClockErrorLo) /
+                                params.WindowClockErrorStep + 0.001f
+                            ) + 1;
+
+    g.nRows = g.nRxSyms * g.nClockError;
+    g.iRow = g.iRxSyms = g.iClockError = 0;
+
+    g.fTable = g.nRows <= kGridRowsMax && this->nSteps <= kGridColsMax;
+    if (g.fTable)
+        memset(g.Percent, kGridNoData, sizeof(g.Percent));
+    }
+
+void cTest::RwTest_t::gridApply(const Params &params)
+    {
+    auto &g = this->Grid;
+
+    if (params.WindowRxSymsStep == 0)
+        g.RxSyms = params.RxSyms;
+    else
+        g.RxSyms = rxsyms_t(params.WindowRxSymsLo + g.iRxSyms * params.WindowRxSymsStep);
+
+    if (params.WindowClockErrorStep == 0.0f)
+        g.ClockError = params.ClockError;
+    else
+        g.ClockError = params.WindowClockErrorLo + g.iClockError * params.WindowClockErrorStep;
+
+    this->RxSymsIn = g.RxSyms;
+    cTest::setClockError(g.ClockError);
+
+    if (g.nRows > 1)
+        {
+        unsigned const ppk = std::fabs(g.ClockError * 10.0f) + 0.5f;
+
+        gCatena.SafePrintf(
+            "Grid %u/%u: ClockError %u.%u%%, RxSyms %u\n",
+            g.iRow + 1,
+            g.nRows,
+            ppk / 10, ppk % 10,
+            g.RxSyms
+            );
+        }
+    }
+
+void cTest::RwTest_t::gridRecord(int col, std::uint32_t nGood, std::uint32_t nTries)
+    {
+    auto &g = this->Grid;
+
+    if (! g.fTable || col < 0 || nTries == 0)
+        return;
+
+    g.Percent[g.iRow][col] = std::uint8_t((nGood * 100 + nTries / 2) / nTries);
+    }
+
+bool cTest::RwTest_t::gridNext()
+    {
+    auto &g = this->Grid;
+
+    if (g.iRow >= g.nRows)
+        return false;
+
+    if (g.fTable && this->Mode == WindowMode::Search)
+        g.Edges[g.iRow] = this->Search;
+
+    ++g.iRow;
+    if (++g.iRxSyms == g.nRxSyms)
+        {
+        g.iRxSyms = 0;
+        ++g.iClockError;
+        }
+
+    return g.iRow < g.nRows;
+    }
+
+void cTest::RwTest_t::gridPrint() const
+    {
+    auto const &g = this->Grid;
+    auto const &params = this->pTest->m_params;
+
+    if (g.nRows <= 1)
+        return;
+
+    if (! g.fTable)
+        {
+        gCatena.SafePrintf(
+            "Grid too large to tabulate (limit %u rows, %u windows)\n",
+            kGridRowsMax,
+            kGridColsMax
+            );
+        return;
+        }
+
+    // heading
+    if (this->Mode == WindowMode::Sweep)
+        {
+        gCatena.SafePrintf("Grid: success (%%) by window (us)\nclkerr rxsyms |");
+        for (unsigned col = 0; col < this->nSteps; ++col)
+            gCatena.SafePrintf(
+                " %6ld",
+                (long) osticks2us(this->WindowStart + ostime_t(col) * this->WindowStep)
+                );
+        }
+    else
+        gCatena.SafePrintf("Grid: edges (us)\nclkerr rxsyms |  early   late  width");
+    gCatena.SafePrintf("\n");
+
+    for (unsigned row = 0; row < g.iRow; ++row)
+        {
+        unsigned const iRxSyms = row % g.nRxSyms;
+        unsigned const iClockError = row / g.nRxSyms;
+        float const clockError = params.WindowClockErrorStep == 0.0f
+                                    ? params.ClockError
+                                    : params.WindowClockErrorLo + iClockError * params.WindowClockErrorStep;
+        unsigned const rxSyms = params.WindowRxSymsStep == 0
+                                    ? params.RxSyms
+                                    : params.WindowRxSymsLo + iRxSyms * params.WindowRxSymsStep;
+        unsigned const ppk = std::fabs(clockError * 10.0f) + 0.5f;
+
+        gCatena.SafePrintf("%3u.%u%% %6u |", ppk / 10, ppk % 10, rxSyms);
+
+        if (this->Mode == WindowMode::Sweep)
+            {
+            for (unsigned col = 0; col < this->nSteps; ++col)
+                {
+                auto const pct = g.Percent[row][col];
+
+                if (pct == kGridNoData)
+                    gCatena.SafePrintf("      -");
+                else
+                    gCatena.SafePrintf(" %6u", pct);
+                }
+            }
+        else
+            {
+            auto const &e = g.Edges[row];
+
+            if (e.phase != Search_t::Phase::Done)
+                gCatena.SafePrintf("  incomplete");
+            else if (! e.fValid)
+                gCatena.SafePrintf("  no reception");
+            else
+                gCatena.SafePrintf(
+                    " %6ld%c %6ld%c %6ld",
+                    (long) osticks2us(e.Early),
+                    e.fEarlyBracketed ? ' ' : '<',
+                    (long) osticks2us(e.Late),
+                    e.fLateBracketed ? ' ' : '>',
+                    (long) osticks2us(e.Late - e.Early)
+                    );
+            }
+        gCatena.SafePrintf("\n");
+        }
+    }
@@ -0,0 +1,95 @@
+/*
+
+Module:  rwc_nst_test_cTest_rwMeasure.cpp
+
+Function:
+    Arrival measurement for the rx window test (cTest::RwTest_t)
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+#include "rwc_nst_test_airtime.h"
+
+using namespace McciCatena;
+
+// In measure mode (param Window.Mode measure), each trigger opens one
+// long receive window, from Window.Start to Window.Stop after the edge,
+// with no drift adjustment. For each frame received, the LMIC reports
+// the rx-done time in LMIC.rxtime; subtracting the frame's computed
+// airtime gives the time its preamble started, so every frame is a
+// direct sample of the trigger-to-arrival offset.
+//
+// Unless the LMIC is built with LMIC_USE_INTERRUPTS, it notices rx-done
+// only when its poll loop next checks the DIO lines, and timestamps the
+// frame then. Each sample then carries that loop latency (a later and
+// wider spread), unlike the trigger edge, which is captured by interrupt
+// where possible. The result line says which applies.
+
+void cTest::RwTest_t::measureWindow()
+    {
+    using rxsym_t = decltype(LMIC.rxsyms);
+    auto const &st = cAirtime::symbolTiming(getSf(LMIC.rps), getBw(LMIC.rps));
+    std::uint32_t const lengthUs = osticks2us(this->WindowStop - this->WindowStart);
+    std::uint32_t nSyms = (lengthUs + st.symbolUs - 1) / st.symbolUs;
+    std::uint32_t const nSymsMax = sizeof(rxsym_t) == sizeof(std::uint8_t) ? 0xFFu : kMeasureRxSymsMax;
+    bool const fLimited = nSyms > nSymsMax;
+
+    if (fLimited)
+        nSyms = nSymsMax;
+
+    LMIC.rxsyms = rxsym_t(nSyms);
+    this->WindowAdjust = this->Window;
+
+    gCatena.SafePrintf(
+        "Measure window: opens %ld us after trigger, %lu symbols (%lu us)%s\n",
+        (long) osticks2us(this->WindowAdjust),
+        (unsigned long) nSyms,
+        (unsigned long) (nSyms * st.symbolUs),
+        fLimited ? ", limited by the radio" : ""
+        );
+    }
+
+void cTest::RwTest_t::measureRecord()
+    {
+    auto params = this->pTest->m_params;
+
+    params.TxLength = LMIC.dataLen;
+
+    float const offset =
+        float(osticks2us(LMIC.rxtime - this->tEdge)) - float(cTest::getTxAirtimeUs(params));
+
+    this->Offset.add(offset);
+    }
+
+void cTest::RwTest_t::printMeasureResult()
+    {
+    auto const &o = this->Offset;
+
+    if (o.getCount() == 0)
+        gCatena.SafePrintf("Arrival: no frames received; check Window.Start and Window.Stop\n");
+    else
+        {
+        gCatena.SafePrintf(
+            "Arrival: %lu frames; preamble starts mean %ld us after trigger (%ld us into window), stddev %ld us, min %ld us, max %ld us\n",
+            (unsigned long) o.getCount(),
+            long(o.getMean()),
+            long(o.getMean() - float(osticks2us(this->Window))),
+            long(o.getStdDev()),
+            long(o.getMin()),
+            long(o.getMax())
+            );
+#if ! defined(LMIC_USE_INTERRUPTS)
+        gCatena.SafePrintf("  (rx-done polled: times include LMIC loop latency)\n");
+#endif
+        }
+
+    this->Offset.reset();
+    }
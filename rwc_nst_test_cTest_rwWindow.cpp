@@ -0,0 +1,284 @@
+/*
+
+Module:  rwc_nst_test_cTest_rwWindow.cpp
+
+Function:
+    Window selection for the rx window test (cTest::RwTest_t)
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+
+// In sweep mode, windows run from Window.Start to Window.Stop by
+// Window.Step, with RxCount tries each; if Window.Width is set, a step
+// ends early once the Wilson interval for its success rate is narrower
+// than Window.Width, or entirely below Window.Low or above Window.High,
+// so tries are spent only where the outcome is uncertain.
+//
+// In search mode, the first probe is the middle of the range, which must
+// be good; then the early edge is bisected between Window.Start and the
+// middle, and the late edge between the middle and Window.Stop, until
+// the bracket is no wider than Window.Step. Each probe takes only as
+// many tries (up to RxCount) as needed to put its success rate above or
+// below Window.Threshold with Window.Confidence.
+//
+// With Window.Order interleave or shuffle, a sweep makes one try at
+// each window per round instead of all its tries at once, and repeats
+// rounds until every window is settled (as above); slow drift over
+// the run then spreads over all windows instead of tilting the curve.
+// Shuffled rounds use a xorshift generator seeded from Window.Seed, so
+// runs are repeatable.
+
+ostime_t cTest::RwTest_t::firstWindow()
+    {
+    if (this->Mode == WindowMode::Search)
+        {
+        auto &s = this->Search;
+
+        s.phase = Search_t::Phase::Center;
+        s.Center = this->WindowStart + (this->WindowStop - this->WindowStart) / 2;
+        s.fValid = false;
+        s.nProbes = 0;
+        return s.Center;
+        }
+    else if (this->isInterleaved())
+        {
+        auto const seed = this->pTest->m_params.WindowSeed;
+
+        this->Random = seed != 0 ? seed : kWindowSeedDefault;
+        this->iRound = 0;
+        this->startRound();
+        this->interleaveNext();
+        return this->Window;
+        }
+    else
+        return this->WindowStart;
+    }
+
+bool cTest::RwTest_t::isStepDone(std::uint32_t nGood, std::uint32_t nTries) const
+    {
+    if (nTries >= this->Count)
+        return true;
+
+    if (this->Mode == WindowMode::Measure)
+        return false;
+
+    if (this->Mode == WindowMode::Search)
+        return cStats::wilsonCompare(nGood, nTries, this->z, this->Threshold)
+                != cStats::Decision::Undecided;
+
+    float lower, upper;
+
+    if (this->Width <= 0.0f ||
+        ! cStats::wilson(nGood, nTries, this->z, lower, upper))
+        return false;
+
+    return upper - lower < this->Width ||
+           upper < this->Low ||
+           lower > this->High;
+    }
+
+void cTest::RwTest_t::startRound()
+    {
+    if (this->iRound++ != 0)
+        gCatena.SafePrintf("\n");
+
+    this->iOrder = 0;
+    for (unsigned i = 0; i < this->nSteps; ++i)
+        this->StepOrder[i] = std::uint8_t(i);
+
+    if (this->Order != WindowOrder::Shuffle)
+        return;
+
+    // Fisher-Yates, with xorshift32.
+    for (unsigned i = this->nSteps - 1; i > 0; --i)
+        {
+        auto x = this->Random;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        this->Random = x;
+
+        unsigned const j = x % (i + 1);
+        auto const t = this->StepOrder[i];
+        this->StepOrder[i] = this->StepOrder[j];
+        this->StepOrder[j] = t;
+        }
+    }
+
+bool cTest::RwTest_t::interleaveNext()
+    {
+    // finish this round; if nothing is left in it, a fresh round with
+    // nothing left means every window is settled.
+    for (unsigned pass = 0; pass < 2; ++pass)
+        {
+        while (this->iOrder < this->nSteps)
+            {
+            unsigned const col = this->StepOrder[this->iOrder++];
+            auto const &s = this->FitSteps[col];
+
+            if (! this->isStepDone(s.nGood, s.nTries))
+                {
+                this->Window = this->WindowStart + ostime_t(col) * this->WindowStep;
+                return true;
+                }
+            }
+        this->startRound();
+        }
+
+    return false;
+    }
+
+bool cTest::RwTest_t::isProbeGood() const
+    {
+    if (this->nTries == 0)
+        return false;
+
+    switch (cStats::wilsonCompare(this->nGood, this->nTries, this->z, this->Threshold))
+        {
+    case cStats::Decision::Above:
+        return true;
+    case cStats::Decision::Below:
+        return false;
+    default:
+        // out of tries; go by the point estimate.
+        return float(this->nGood) >= this->Threshold * float(this->nTries);
+        }
+    }
+
+bool cTest::RwTest_t::nextWindow(bool fGood)
+    {
+    // measure mode has only the one window.
+    if (this->Mode == WindowMode::Measure)
+        return false;
+
+    if (this->Mode != WindowMode::Search)
+        {
+        this->Window += this->WindowStep;
+
+        if (this->WindowStep >= 0)
+            return this->Window <= this->WindowStop;
+        else
+            return this->Window >= this->WindowStop;
+        }
+
+    auto &s = this->Search;
+
+    ++s.nProbes;
+    switch (s.phase)
+        {
+    case Search_t::Phase::Center:
+        if (! fGood)
+            {
+            s.phase = Search_t::Phase::Done;
+            return false;
+            }
+        s.fValid = true;
+        s.phase = Search_t::Phase::Early;
+        s.lo = this->WindowStart;
+        s.hi = s.Center;
+        s.fEarlyBracketed = false;
+        break;
+
+    // early edge: bad at lo, good at hi.
+    case Search_t::Phase::Early:
+        if (fGood)
+            s.hi = this->Window;
+        else
+            {
+            s.lo = this->Window;
+            s.fEarlyBracketed = true;
+            }
+        break;
+
+    // late edge: good at lo, bad at hi.
+    case Search_t::Phase::Late:
+        if (fGood)
+            s.lo = this->Window;
+        else
+            {
+            s.hi = this->Window;
+            s.fLateBracketed = true;
+            }
+        break;
+
+    default:
+        return false;
+        }
+
+    return this->searchNext();
+    }
+
+bool cTest::RwTest_t::searchNext()
+    {
+    auto &s = this->Search;
+
+    for (;;)
+        {
+        ostime_t const mid = s.lo + (s.hi - s.lo) / 2;
+
+        if (s.hi - s.lo > this->WindowStep)
+            {
+            this->Window = mid;
+            return true;
+            }
+
+        if (s.phase == Search_t::Phase::Early)
+            {
+            s.Early = mid;
+            s.phase = Search_t::Phase::Late;
+            s.lo = s.Center;
+            s.hi = this->WindowStop;
+            s.fLateBracketed = false;
+            }
+        else
+            {
+            s.Late = mid;
+            s.phase = Search_t::Phase::Done;
+            return false;
+            }
+        }
+    }
+
+void cTest::RwTest_t::printSearchResult() const
+    {
+    auto const &s = this->Search;
+
+    if (s.phase != Search_t::Phase::Done)
+        {
+        gCatena.SafePrintf("Edge search incomplete.\n");
+        return;
+        }
+    if (! s.fValid)
+        {
+        gCatena.SafePrintf(
+            "** no reception at window %ld us: check Window.Start and Window.Stop **\n",
+            (long) osticks2us(s.Center)
+            );
+        return;
+        }
+
+    gCatena.SafePrintf(
+        "Edge search: %u probes; early edge %ld us%s, late edge %ld us%s\n",
+        s.nProbes,
+        (long) osticks2us(s.Early),
+        s.fEarlyBracketed ? "" : " (at or before Window.Start)",
+        (long) osticks2us(s.Late),
+        s.fLateBracketed ? "" : " (at or after Window.Stop)"
+        );
+    gCatena.SafePrintf(
+        "Window margin: %ld us wide, centered at %ld us (resolution %ld us)\n",
+        (long) osticks2us(s.Late - s.Early),
+        (long) osticks2us(s.Early + (s.Late - s.Early) / 2),
+        (long) osticks2us(this->WindowStep)
+        );
+    }
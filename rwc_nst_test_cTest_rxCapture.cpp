@@ -0,0 +1,123 @@
+/*
+
+Module:  rwc_nst_test_cTest_rxCapture.cpp
+
+Function:
+    cTest::cRxCapture implementation
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+
+using namespace McciCatena;
+
+void cTest::cRxCapture::put(cTest::RxResult result)
+    {
+    auto &e = this->m_ring[this->m_head];
+    auto const len = LMIC.dataLen;
+    unsigned const n = len < kBytes ? len : kBytes;
+
+    e.time = LMIC.rxtime;
+    e.rssi = std::int16_t(LMIC.rssi - RSSI_OFF);
+    e.snr4 = LMIC.snr;
+    e.len = len;
+    e.result = result;
+    memcpy(e.data, LMIC.frame, n);
+    memset(e.data + n, 0, kBytes - n);
+
+    if (++this->m_head == kEntries)
+        this->m_head = 0;
+    if (this->m_n < kEntries)
+        ++this->m_n;
+    ++this->m_nTotal;
+    }
+
+// one line per packet:
+//      index time-ms len rssi snr class: bytes...
+void cTest::cRxCapture::printText(cCommandStream *pThis) const
+    {
+    pThis->printf(
+        "rx capture: %u of %lu packets\n",
+        this->m_n,
+        (unsigned long) this->m_nTotal
+        );
+
+    for (unsigned i = 0; i < this->m_n; ++i)
+        {
+        auto const &e = this->getEntry(i);
+        int const snr4 = e.snr4;
+        unsigned const snrAbs = snr4 < 0 ? -snr4 : snr4;
+
+        pThis->printf(
+            "%2u %9ld %3u %4d %s%u.%02u %c:",
+            i,
+            (long) osticks2ms(e.time),
+            e.len,
+            e.rssi,
+            snr4 < 0 ? "-" : "",
+            snrAbs / 4, (snrAbs & 3) * 25,
+            getRxResultChar(e.result)
+            );
+
+        unsigned const n = e.len < kBytes ? e.len : kBytes;
+        for (unsigned j = 0; j < n; ++j)
+            pThis->printf(" %02x", e.data[j]);
+
+        pThis->printf("%s\n", e.len > kBytes ? " ..." : "");
+        }
+    }
+
+// Binary format, all little-endian:
+//      header: "RXCP", version (1 byte), entry count (2 bytes),
+//              entry size (1 byte)
+//      entries: time (4), rssi (2), snr*4 (1), len (1), class (1),
+//              data (kBytes)
+// The command stream only takes formatted text, which can't carry NUL
+// bytes, so the header and each entry are written as one line of hex.
+static void writeHexLine(cCommandStream *pThis, const std::uint8_t *pBuf, unsigned nBuf)
+    {
+    for (unsigned i = 0; i < nBuf; ++i)
+        pThis->printf("%02x", pBuf[i]);
+    pThis->printf("\n");
+    }
+
+void cTest::cRxCapture::writeBinary(cCommandStream *pThis) const
+    {
+    static constexpr std::uint8_t kVersion = 1;
+    static constexpr std::uint8_t kEntrySize = 4 + 2 + 1 + 1 + 1 + kBytes;
+    std::uint8_t buf[kEntrySize];
+
+    buf[0] = 'R'; buf[1] = 'X'; buf[2] = 'C'; buf[3] = 'P';
+    buf[4] = kVersion;
+    buf[5] = std::uint8_t(this->m_n);
+    buf[6] = std::uint8_t(this->m_n >> 8);
+    buf[7] = kEntrySize;
+    writeHexLine(pThis, buf, 8);
+
+    for (unsigned i = 0; i < this->m_n; ++i)
+        {
+        auto const &e = this->getEntry(i);
+        auto const t = std::uint32_t(e.time);
+        auto const rssi = std::uint16_t(e.rssi);
+
+        buf[0] = std::uint8_t(t);
+        buf[1] = std::uint8_t(t >> 8);
+        buf[2] = std::uint8_t(t >> 16);
+        buf[3] = std::uint8_t(t >> 24);
+        buf[4] = std::uint8_t(rssi);
+        buf[5] = std::uint8_t(rssi >> 8);
+        buf[6] = std::uint8_t(e.snr4);
+        buf[7] = e.len;
+        buf[8] = std::uint8_t(e.result);
+        memcpy(buf + 9, e.data, kBytes);
+        writeHexLine(pThis, buf, sizeof(buf));
+        }
+    }
@@ -16,6 +16,8 @@ Author:
 #include "rwc_nst_test_cTest.h"
 
 #include "rwc_nst_test.h"
+#include "rwc_nst_test_radio.h"
+#include "rwc_nst_test_stats.h"
 
 // receive test driver
 bool cTest::rxTest(
@@ -29,9 +31,33 @@ bool cTest::rxTest(
         this->m_Rx.fContinuous = this->m_Rx.Timeout == 0;
         this->m_Rx.fTimedOut = false;
         this->m_Rx.Count = 0;
+        this->m_Rx.Results.reset();
+        this->m_Rx.FreqError.reset();
+        this->m_Rx.NoiseFloor.reset();
+        this->m_Rx.NoisePeak = INT16_MIN;
+        this->m_Rx.NoiseTicksMin = us2osticks(this->m_params.RxRssiIntervalUs);
+        this->m_Rx.fSeenGood = false;
+        this->m_Rx.tSpacing = 0;
+        this->m_RxCapture.reset();
         this->m_Rx.fReceiving = false;
         this->m_RxDigOut.setOutput(this->m_params.RxDigOut, true);
 
+        auto &per = this->m_Rx.Per;
+        per.fEnabled = this->m_params.RxPerTarget > 0.0f;
+        per.fStarted = per.fDecided = per.fPass = false;
+        per.nSlots = 0;
+        if (per.fEnabled)
+            {
+            if (this->m_params.RxPerInterval == 0)
+                {
+                gCatena.SafePrintf("** please set param RxPer.Interval to the generator packet interval **\n");
+                return true;
+                }
+            per.tInterval = ms2osticks(this->m_params.RxPerInterval);
+            per.Target = this->m_params.RxPerTarget / 100.0f;
+            per.z = cStats::normalQuantile(this->m_params.RxPerConfidence / 100.0f);
+            }
+
         gCatena.SafePrintf("Start RX test: capturing raw downlink ");
         if (m_Rx.fContinuous)
             gCatena.SafePrintf("until canceled by `count` command");
@@ -43,6 +69,26 @@ bool cTest::rxTest(
             gCatena.SafePrintf(" pulsing digital I/O %d", this->m_params.RxDigOut);
             }
 
+        if (per.fEnabled)
+            {
+            char sTarget[16], sConfidence[16];
+
+            this->getParamByKey(ParamKey::RxPerTarget, sTarget, sizeof(sTarget));
+            this->getParamByKey(ParamKey::RxPerConfidence, sConfidence, sizeof(sConfidence));
+            gCatena.SafePrintf(
+                ", stopping when PER vs %s is decided at %s confidence (packets every %u ms)",
+                sTarget, sConfidence, this->m_params.RxPerInterval
+                );
+            }
+
+        if (this->m_params.RxRssiIntervalUs != 0)
+            {
+            gCatena.SafePrintf(
+                ", sampling noise floor for %u us after each packet",
+                this->m_params.RxRssiIntervalUs
+                );
+            }
+
         gCatena.SafePrintf(
             ".\n"
             "At RWC5020, select NST>Signal Generator, then Run.\n"
@@ -78,18 +124,47 @@ bool cTest::rxTest(
         {
         this->rxTestStop();
         gCatena.SafePrintf(
-            "\nRX test stopped: received messages: %u.\n",
+            "\nRX test stopped: received messages: %u",
             this->m_Rx.Count
             );
+        this->m_Rx.Results.print();
+        gCatena.SafePrintf(".\n");
+        this->rxTestPrintStats();
+        return true;
+        }
+    else if (this->m_Rx.Per.fEnabled && this->rxPerEval(os_getTime()))
+        {
+        auto const &per = this->m_Rx.Per;
+        unsigned const perLower = unsigned(per.Lower * 1000.0f + 0.5f);
+        unsigned const perUpper = unsigned(per.Upper * 1000.0f + 0.5f);
+
+        this->rxTestStop();
+        gCatena.SafePrintf(
+            "\nRX test %s: received messages: %u/%u, PER %u.%u%% to %u.%u%%",
+            per.fPass ? "PASS" : "FAIL",
+            this->m_Rx.Count,
+            per.nSlots,
+            perLower / 10, perLower % 10,
+            perUpper / 10, perUpper % 10
+            );
+        this->m_Rx.Results.print();
+        gCatena.SafePrintf(".\n");
+        this->rxTestPrintStats();
         return true;
         }
     else if (this->m_Rx.fTimedOut)
         {
         this->rxTestStop();
         gCatena.SafePrintf(
-            "\nRX test complete: received messages: %u.\n",
+            "\nRX test complete: received messages: %u",
             this->m_Rx.Count
             );
+        this->m_Rx.Results.print();
+        gCatena.SafePrintf(
+            "%s.\n",
+            this->m_Rx.Per.fEnabled ? ", PER undecided" : ""
+            );
+        this->rxTestPrintStats();
         return true;
         }
     else
@@ -99,17 +174,46 @@ bool cTest::rxTest(
             // set the coallback processor.
             LMIC.osjob.func = [](osjob_t *job)
                 {
+                auto const result = cTest::classifyRx();
+
+                gTest.m_Rx.Results.count(result);
                 if (LMIC.dataLen > 0)
+                    gTest.m_RxCapture.put(result);
+                if (result == RxResult::Good)
+                    {
                     ++gTest.m_Rx.Count;
+                    gTest.rxRecordSpacing();
+
+                    if (getSf(LMIC.rps) != FSK)
+                        gTest.m_Rx.FreqError.add(
+                            float(cRadio::getLoraFreqErrorHz(getBw(LMIC.rps)))
+                            );
+
+                    auto &per = gTest.m_Rx.Per;
+                    if (per.fEnabled && ! per.fStarted)
+                        {
+                        // packet slots are counted from here.
+                        per.tFirst = LMIC.rxtime;
+                        per.fStarted = true;
+                        }
+                    }
+
+                gCatena.SafePrintf("%c", result == RxResult::Good ? '.' : getRxResultChar(result));
+
+                // the generator is idle right after a packet: sample the
+                // channel before restarting the receiver.
+                if (LMIC.lbt_ticks != 0)
+                    gTest.rxSampleNoise();
 
-                gCatena.SafePrintf(".");
                 gTest.m_Rx.fReceiving = false;
                 gTest.m_fsm.eval();
                 };
 
             LMIC.rxtime = os_getTime();
             this->m_Rx.fReceiving = true;
-            os_radio(RADIO_RXON);
+            this->startRadio(RADIO_RXON);
+            if (getSf(LMIC.rps) != FSK)
+                cRadio::enableRxDiagIrqs();
             }
         return false;
         }
@@ -122,3 +226,213 @@ void cTest::rxTestStop()
     os_clearCallback(&this->m_Rx.TimeoutJob);
     }
 
+
+// print a signed value given in hundredths as [-]n.nn
+static void printHundredths(std::int32_t v)
+    {
+    std::uint32_t const a = v < 0 ? -v : v;
+
+    gCatena.SafePrintf("%s%lu.%02lu",
+        v < 0 ? "-" : "",
+        (unsigned long)(a / 100),
+        (unsigned long)(a % 100)
+        );
+    }
+
+// print the rx test statistics that follow the summary line.
+// The frequency error is the receiver's estimate of the incoming
+// carrier relative to its own synthesizer; taking the generator as
+// the reference, the DUT's carrier offset is the negative of that.
+void cTest::rxTestPrintStats() const
+    {
+    auto const &nf = this->m_Rx.NoiseFloor;
+
+    if (nf.getCount() != 0)
+        {
+        gCatena.SafePrintf(
+            "Noise floor: %lu samples, mean %d dB, min %d dB, max %d dB, peak %d dB%s\n",
+            (unsigned long) nf.getCount(),
+            int(nf.getMean() - 0.5f),
+            int(nf.getMin()),
+            int(nf.getMax()),
+            this->m_Rx.NoisePeak,
+            this->m_Rx.NoisePeak >= this->m_params.RxRssiDbMax
+                ? " ** exceeds LBT.dB: check fixture **"
+                : ""
+            );
+        if (this->m_Rx.NoiseTicksMin < LMIC.lbt_ticks)
+            gCatena.SafePrintf(
+                "Noise sample time limited by packet gap: shortest %lu us\n",
+                (unsigned long) osticks2us(this->m_Rx.NoiseTicksMin)
+                );
+        }
+
+    auto const &fe = this->m_Rx.FreqError;
+
+    if (fe.getCount() == 0)
+        return;
+
+    float const freqMHz = float(this->m_params.Freq) / 1e6f;
+    auto const ppmX100 = [freqMHz](float hz) -> std::int32_t
+        {
+        float const v = hz / freqMHz * 100.0f;
+        return std::int32_t(v < 0.0f ? v - 0.5f : v + 0.5f);
+        };
+    auto const round = [](float v) -> long
+        {
+        return long(v < 0.0f ? v - 0.5f : v + 0.5f);
+        };
+
+    gCatena.SafePrintf(
+        "Freq error: %lu packets, mean %ld Hz, min %ld Hz, max %ld Hz, stddev %ld Hz\n",
+        (unsigned long) fe.getCount(),
+        round(fe.getMean()),
+        round(fe.getMin()),
+        round(fe.getMax()),
+        round(fe.getStdDev())
+        );
+    gCatena.SafePrintf("DUT carrier offset vs generator: %ld Hz (", round(-fe.getMean()));
+    printHundredths(ppmX100(-fe.getMean()));
+    gCatena.SafePrintf(" ppm)\n");
+    }
+
+// track the spacing between good packets; the shortest one seen is
+// taken as the generator interval when param RxPer.Interval isn't set.
+void cTest::rxRecordSpacing()
+    {
+    auto &rx = this->m_Rx;
+
+    if (rx.fSeenGood)
+        {
+        ostime_t const dt = LMIC.rxtime - rx.tLastGood;
+
+        if (dt > 0 && (rx.tSpacing == 0 || dt < rx.tSpacing))
+            rx.tSpacing = dt;
+        }
+
+    rx.tLastGood = LMIC.rxtime;
+    rx.fSeenGood = true;
+    }
+
+// Sample the channel RSSI on the test frequency, using the LMIC's
+// listen-before-talk measurement. The LMIC returns the mean, min and
+// max over the interval; the mean goes into the noise-floor statistics
+// and the max into the peak.
+//
+// The measurement blocks, and the receiver is off while it runs, so it
+// must end well before the generator's next packet. The idle gap is
+// the generator interval (param RxPer.Interval, or else the shortest
+// spacing seen so far) less the airtime of the packet just received;
+// the sample is limited to half of that, leaving time to restart the
+// receiver ahead of the preamble. Until the gap is known, no sample is
+// taken. A shorter sample is noisier, so the summary reports the
+// shortest sample used.
+void cTest::rxSampleNoise()
+    {
+    oslmic_radio_rssi_t rssi;
+    ostime_t const tInterval = this->m_params.RxPerInterval != 0
+                                ? ms2osticks(this->m_params.RxPerInterval)
+                                : this->m_Rx.tSpacing;
+
+    if (tInterval == 0 || LMIC.dataLen == 0)
+        return;
+
+    auto params = this->m_params;
+
+    params.TxLength = LMIC.dataLen;
+
+    ostime_t const tGap = tInterval - us2osticks(cTest::getTxAirtimeUs(params));
+    ostime_t tSample = LMIC.lbt_ticks;
+
+    if (tSample > tGap / 2)
+        tSample = tGap / 2;
+    if (tSample <= 0)
+        return;
+
+    radio_monitor_rssi(tSample, &rssi);
+    if (rssi.n_rssi == 0)
+        return;
+
+    if (tSample < this->m_Rx.NoiseTicksMin)
+        this->m_Rx.NoiseTicksMin = tSample;
+    this->m_Rx.NoiseFloor.add(float(rssi.mean_rssi));
+    if (rssi.max_rssi > this->m_Rx.NoisePeak)
+        this->m_Rx.NoisePeak = rssi.max_rssi;
+    }
+
+// Classify the receive that just completed. The LMIC's interrupt handler
+// saves the LoRa IRQ flags in LMIC.saveIrqFlags; the rx paths unmask
+// PayloadCrcError (cRadio::enableRxDiagIrqs()) so it is present as well.
+// The SX127x has no header-error IRQ: a frame whose header fails its
+// check, or that is lost after the header, ends as a plain RxTimeout,
+// so it's counted as a timeout. FSK receives are only good or timed out.
+cTest::RxResult cTest::classifyRx()
+    {
+    if (getSf(LMIC.rps) == FSK)
+        return LMIC.dataLen > 0 ? RxResult::Good : RxResult::Timeout;
+
+    auto const flags = LMIC.saveIrqFlags;
+
+    if (! (flags & cRadio::kLoraIrqRxDone))
+        return RxResult::Timeout;
+    else if (flags & cRadio::kLoraIrqPayloadCrcError)
+        return RxResult::CrcError;
+    else
+        return RxResult::Good;
+    }
+
+void cTest::RxResultCounts_t::print() const
+    {
+    gCatena.SafePrintf(
+        ", crc %u, timeout %u",
+        this->get(RxResult::CrcError),
+        this->get(RxResult::Timeout)
+        );
+    }
+
+// Evaluate the sequential PER test at time `now`. The generator sends a
+// packet every tInterval, starting with the first packet we received.
+// A slot counts as a trial once its packet has arrived, or once half an
+// interval has passed without it. After each new slot, the Wilson score
+// interval for the failure rate is compared to the target; the test is
+// decided as soon as the interval lies entirely on one side.
+bool cTest::rxPerEval(ostime_t now)
+    {
+    auto &per = this->m_Rx.Per;
+
+    if (per.fDecided)
+        return true;
+    if (! per.fStarted)
+        return false;
+
+    std::uint32_t nSlots = 1;
+    ostime_t const tElapsed = now - per.tFirst - per.tInterval / 2;
+
+    if (tElapsed >= 0)
+        nSlots += std::uint32_t(tElapsed / per.tInterval);
+    if (nSlots < this->m_Rx.Count)
+        nSlots = this->m_Rx.Count;
+
+    // only re-evaluate when there's a new trial.
+    if (nSlots == per.nSlots)
+        return false;
+    per.nSlots = nSlots;
+
+    std::uint32_t const nFail = nSlots - this->m_Rx.Count;
+    cStats::wilson(nFail, nSlots, per.z, per.Lower, per.Upper);
+
+    switch (cStats::wilsonCompare(nFail, nSlots, per.z, per.Target))
+        {
+    case cStats::Decision::Below:
+        per.fDecided = per.fPass = true;
+        break;
+    case cStats::Decision::Above:
+        per.fDecided = true;
+        per.fPass = false;
+        break;
+    default:
+        break;
+        }
+
+    return per.fDecided;
+    }
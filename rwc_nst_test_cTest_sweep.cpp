@@ -0,0 +1,268 @@
+/*
+
+Module:  rwc_nst_test_cTest_sweep.cpp
+
+Function:
+    cTest::sweepTest() implementation
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+#include <mcciadk_baselib.h>
+
+// transmit sweep driver
+// fEntry is true to start a test, false subequently.
+// The sweep sends `param Sweep.Count` frames at each point of the plan
+// given by `param Sweep.SF`, `param Sweep.Freq` and `param Sweep.Power`
+// (power varying fastest), and prints one record per point. Frames are
+// sent back to back, and the radio is reconfigured between points
+// without resetting the LMIC, so there's little dead time.
+bool cTest::sweepTest(
+    bool fEntry
+    )
+    {
+    if (fEntry)
+        {
+        this->m_fStopTest = false;
+        if (! this->m_SweepTest.begin(*this))
+            return true;
+        }
+
+    return this->m_SweepTest.poll();
+    }
+
+bool cTest::SweepTest_t::begin(cTest &Test)
+    {
+    auto const &params = Test.m_params;
+
+    this->pTest = &Test;
+    this->fRunning = false;
+
+    if (params.SweepCount == 0)
+        {
+        gCatena.SafePrintf("** please set param Sweep.Count to a non-zero value **\n");
+        return false;
+        }
+
+    this->nSf = 0;
+    if (params.SweepSfMask == 0)
+        this->Sf[this->nSf++] = params.SpreadingFactor;
+    else
+        {
+        for (unsigned sf = FSK; sf <= SF12; ++sf)
+            {
+            if (params.SweepSfMask & (1u << sf))
+                this->Sf[this->nSf++] = sf_t(sf);
+            }
+        }
+
+    if (params.SweepFreqN == 0)
+        this->nFreq = 1;
+    else if (params.SweepFreqStep == 0)
+        this->nFreq = params.SweepFreqN;
+    else
+        this->nFreq = (params.SweepFreq[1] - params.SweepFreq[0]) / params.SweepFreqStep + 1;
+
+    if (params.SweepPowerStep == 0)
+        this->nPower = 1;
+    else
+        this->nPower = (params.SweepPowerHi - params.SweepPowerLo) / params.SweepPowerStep + 1;
+
+    this->nPoints = this->nSf * this->nFreq * this->nPower;
+    this->iSf = this->iFreq = this->iPower = this->iPoint = 0;
+
+    if (! Test.buildTxPayload())
+        return false;
+    Test.m_Tx.nSent = 0;
+
+    gCatena.SafePrintf(
+        "Start TX sweep: %u points, %lu frames per point. ",
+        this->nPoints,
+        (unsigned long) params.SweepCount
+        );
+
+    this->Fsm.init(*this, &SweepTest_t::fsmDispatch);
+    this->Fsm.eval();
+
+    return true;
+    }
+
+bool cTest::SweepTest_t::poll()
+    {
+    if (! this->fRunning)
+        return true;
+
+    os_runloop_once();
+    this->Fsm.eval();
+    return false;
+    }
+
+std::uint32_t cTest::SweepTest_t::getFreq(unsigned i) const
+    {
+    auto const &params = this->pTest->m_params;
+
+    if (params.SweepFreqN == 0)
+        return params.Freq;
+    else if (params.SweepFreqStep == 0)
+        return params.SweepFreq[i];
+    else
+        return params.SweepFreq[0] + i * params.SweepFreqStep;
+    }
+
+bool cTest::SweepTest_t::nextPoint()
+    {
+    ++this->iPoint;
+    if (++this->iPower < this->nPower)
+        return true;
+    this->iPower = 0;
+    if (++this->iFreq < this->nFreq)
+        return true;
+    this->iFreq = 0;
+    return ++this->iSf < this->nSf;
+    }
+
+// one line per point, as name=value pairs for ease of parsing.
+void cTest::SweepTest_t::printPoint() const
+    {
+    auto const &p = this->Point;
+    char sf[4];
+
+    if (p.SpreadingFactor == FSK)
+        McciAdkLib_Snprintf(sf, sizeof(sf), 0, "FSK");
+    else
+        McciAdkLib_Snprintf(sf, sizeof(sf), 0, "%u", p.SpreadingFactor + 7 - SF7);
+
+    gCatena.SafePrintf(
+        "Sweep %u/%u: freq=%lu sf=%s bw=%u pwr=%d frames=%lu ms=%ld airtime=%lu latency=%ld\n",
+        this->iPoint + 1,
+        this->nPoints,
+        (unsigned long) p.Freq,
+        sf,
+        125u << p.Bandwidth,
+        p.TxPower,
+        (unsigned long) this->nSent,
+        (long) osticks2ms(this->tLastDone - this->tFirst),
+        (unsigned long) this->AirtimeUs,
+        long(this->Latency.getMean())
+        );
+    }
+
+cTest::SweepTest_t::State cTest::SweepTest_t::fsmDispatch(
+    cTest::SweepTest_t::State curState,
+    bool fEntry
+    )
+    {
+    State newState = State::stNoChange;
+    auto const &params = this->pTest->m_params;
+
+    switch (curState)
+        {
+    case State::stInitial:
+        this->fRunning = true;
+        this->pTest->setupLMIC(params);
+        os_radio(RADIO_RST);
+        memcpy(LMIC.frame, this->pTest->m_Tx.Data, this->pTest->m_Tx.nData);
+        LMIC.dataLen = this->pTest->m_Tx.nData;
+
+        newState = State::stPoint;
+        break;
+
+    case State::stPoint:
+        // reconfigure quietly; os_radio() applies these on each tx.
+        this->Point = params;
+        this->Point.SpreadingFactor = this->Sf[this->iSf];
+        this->Point.Freq = this->getFreq(this->iFreq);
+        if (params.SweepPowerStep != 0)
+            this->Point.TxPower = std::int8_t(
+                params.SweepPowerLo + this->iPower * params.SweepPowerStep
+                );
+
+        LMIC.freq = this->Point.Freq;
+        LMIC.rps = cTest::getRps(this->Point);
+        LMIC.radio_txpow = this->Point.TxPower;
+        this->AirtimeUs = cTest::getTxAirtimeUs(this->Point);
+        if (! this->pTest->dutyCycleCheck(this->AirtimeUs))
+            {
+            newState = State::stFinal;
+            break;
+            }
+
+        this->nSent = 0;
+        this->Latency.reset();
+        this->fTxComplete = true;
+        newState = State::stTx;
+        break;
+
+    case State::stTx:
+        if (this->pTest->m_fStopTest)
+            {
+            os_clearCallback(&LMIC.osjob);
+            os_radio(RADIO_RST);
+            gCatena.SafePrintf("Sweep stopped.\n");
+            newState = State::stFinal;
+            }
+        else if (! this->fTxComplete ||
+                 this->pTest->dutyCycleDelay(this->AirtimeUs) != 0)
+            {
+            // wait.
+            }
+        else if (this->nSent < params.SweepCount)
+            {
+            auto const tNow = os_getTime();
+
+            if (this->nSent == 0)
+                this->tFirst = tNow;
+
+            this->pTest->patchTxPayload(this->pTest->m_Tx.nSent++, tNow);
+            ++this->nSent;
+
+            LMIC.osjob.func =
+                [](osjob_t *job) -> void
+                    {
+                    auto &sweep = gTest.m_SweepTest;
+
+                    sweep.tLastDone = LMIC.txend;
+                    sweep.Latency.add(float(osticks2us(LMIC.txend - sweep.tIssue)));
+                    gTest.dutyCycleRecord(sweep.tIssue, sweep.AirtimeUs);
+                    sweep.fTxComplete = true;
+                    };
+
+            this->fTxComplete = false;
+            this->tIssue = os_getTime();
+            this->pTest->startRadio(RADIO_TX);
+            }
+        else
+            {
+            this->printPoint();
+            if (this->nextPoint())
+                newState = State::stPoint;
+            else
+                {
+                gCatena.SafePrintf("Sweep complete.\n");
+                newState = State::stFinal;
+                }
+            }
+        break;
+
+    default:
+        newState = State::stFinal;
+        break;
+
+    case State::stFinal:
+        if (fEntry)
+            {
+            this->fRunning = false;
+            }
+        break;
+        }
+
+    return newState;
+    }
@@ -70,8 +70,10 @@ bool cTest::TwTest_t::begin(cTest &Test)
     this->tGuard = us2osticksRound(Test.m_params.TxGuardUs);
     this->tStartup = us2osticksRound(Test.m_params.TxStartUs);
 
-    if (this->tDelay <= 0 || this->tPulse <= 0)
+    if (Test.m_params.TxInterval == kTxIntervalAuto ||
+        this->tDelay <= 0 || this->tPulse <= 0)
         {
+        // TxInterval "auto" has no meaning here.
         gCatena.SafePrintf("** please specify positive, non-zero param TxInterval and TxPulseMs **\n");
         return false;
         }
@@ -81,6 +83,13 @@ bool cTest::TwTest_t::begin(cTest &Test)
         gCatena.SafePrintf("** please set param TxPulseOut to tx pulse output **\n");
         return false;
         }
+    if (! Test.buildTxPayload())
+        return false;
+    Test.m_Tx.nSent = 0;
+    Test.m_Tx.StartError.reset();
+    Test.txOnAirReset();
+    if (! Test.dutyCycleCheck(Test.m_Tx.AirtimeUs))
+        return false;
     Test.m_TxDigOut.setOutput(Test.m_params.TxDigOut, true);
 
     this->Fsm.init(*this, &TwTest_t::fsmDispatch);
@@ -140,6 +149,10 @@ cTest::TwTest_t::State cTest::TwTest_t::fsmDispatch(
             // load up the buffer.
             memcpy(LMIC.frame, this->pTest->m_Tx.Data, this->pTest->m_Tx.nData);
             LMIC.dataLen = this->pTest->m_Tx.nData;
+            this->pTest->patchTxPayload(
+                this->pTest->m_Tx.nSent++,
+                this->tEdge + this->tDelay
+                );
             }
 
         if (this->pTest->m_fStopTest)
@@ -155,17 +168,31 @@ cTest::TwTest_t::State cTest::TwTest_t::fsmDispatch(
             LMIC.osjob.func =
                 [](osjob_t *job) -> void
                     {
-                    gTest.m_TwTest.fTxComplete = true;
+                    auto &tw = gTest.m_TwTest;
+                    auto &tx = gTest.m_Tx;
+
+                    // as in txTestDone(): against the keying target.
+                    tx.StartError.add(
+                        float(osticks2us(tx.tStart - (tw.tEdge + tw.tDelay - tw.tStartup)))
+                        );
+                    gTest.txOnAirRecord();
+                    gTest.dutyCycleRecord(tx.tStart, tx.AirtimeUs);
+                    tw.fTxComplete = true;
                     };
 
             this->fTxComplete = false;
+            this->pTest->m_Tx.fStartSeen = false;
             LMIC.txend = this->tEdge + this->tDelay - this->tStartup;
 
 #if ARDUINO_LMIC_VERSION >= ARDUINO_LMIC_VERSION_CALC(3,0,99,8)
-                os_radio(RADIO_TX_AT);
+                this->pTest->startRadio(RADIO_TX_AT);
 #else
-                os_radio(RADIO_TX);
+                this->pTest->startRadio(RADIO_TX);
 #endif
+
+            // as in txTest(), if the LMIC didn't log the start.
+            if (! this->pTest->m_Tx.fStartSeen)
+                this->pTest->m_Tx.tStart = os_getTime();
             }
 
         if (this->pTest->m_fStopTest)
@@ -191,7 +218,8 @@ cTest::TwTest_t::State cTest::TwTest_t::fsmDispatch(
 
         if (this->pTest->m_fStopTest)
             newState = State::stFinal;
-        else if (os_getTime() - this->tEdge >= this->tPulse)
+        else if (os_getTime() - this->tEdge >= this->tPulse &&
+                 this->pTest->dutyCycleDelay(this->pTest->m_Tx.AirtimeUs) == 0)
             newState = State::stPulse;
         break;
 
@@ -203,6 +231,7 @@ cTest::TwTest_t::State cTest::TwTest_t::fsmDispatch(
         if (fEntry)
             {
             this->fRunning = false;
+            this->pTest->txTestPrintStats();
             gCatena.SafePrintf("End Tx Window Test\n");
             }
         break;
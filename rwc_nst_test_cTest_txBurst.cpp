@@ -0,0 +1,164 @@
+/*
+
+Module:  rwc_nst_test_cTest_txBurst.cpp
+
+Function:
+    cTest::txBurstTest() implementation
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+#include "rwc_nst_test_radio.h"
+
+// transmit burst test driver
+// fEntry is true to start a test, false subequently.
+// The burst test sends `param TxTestCount` frames (forever if zero) with
+// no requested interval: each frame is issued as soon as the previous
+// tx-done has been processed and the radio is idle. Nothing is printed
+// per frame, so the measured rate reflects driver and loop overhead.
+bool cTest::txBurstTest(
+    bool fEntry
+    )
+    {
+    auto &tx = this->m_Tx;
+
+    if (fEntry)
+        {
+        this->m_fStopTest = false;
+        tx.Count = this->m_params.TxTestCount;
+        tx.fIdle = true;
+        tx.fContinuous = tx.Count == 0;
+        tx.nSent = 0;
+        tx.Burst.Latency.reset();
+        tx.Burst.Gap.reset();
+        this->txOnAirReset();
+
+        if (! this->buildTxPayload() || ! this->dutyCycleCheck(tx.AirtimeUs))
+            return true;
+
+        gCatena.SafePrintf(
+            "Start TX burst test: %u bytes (%s), ",
+            tx.nData,
+            getTxPatternName(this->m_params.TxPatternKind)
+            );
+        if (tx.fContinuous)
+            gCatena.SafePrintf("until canceled by `q` command");
+        else
+            gCatena.SafePrintf("%u packets", tx.Count);
+
+        gCatena.SafePrintf(". ");
+        this->setupLMIC(this->m_params);
+
+        os_radio(RADIO_RST);
+        memcpy(LMIC.frame, tx.Data, tx.nData);
+        LMIC.dataLen = tx.nData;
+        }
+
+    os_runloop_once();
+
+    if (! tx.fIdle)
+        return false;
+    else if (this->m_fStopTest)
+        {
+        gCatena.SafePrintf("TX burst test stopped.\n");
+        this->txBurstPrintStats();
+        return true;
+        }
+    else if (tx.Count == 0 && ! tx.fContinuous)
+        {
+        gCatena.SafePrintf("TX burst test complete.\n");
+        this->txBurstPrintStats();
+        return true;
+        }
+    else if (! cRadio::isIdle())
+        {
+        return false;
+        }
+    else if (this->dutyCycleDelay(tx.AirtimeUs) != 0)
+        {
+        return false;
+        }
+    else
+        {
+        if (! tx.fContinuous)
+            --tx.Count;
+
+        auto const tNow = os_getTime();
+
+        if (tx.nSent == 0)
+            tx.Burst.tFirst = tNow;
+        else
+            tx.Burst.Gap.add(float(osticks2us(tNow - tx.Burst.tLastDone)));
+
+        this->patchTxPayload(tx.nSent++, tNow);
+
+        LMIC.osjob.func = cTest::txBurstDone;
+        tx.fIdle = false;
+        tx.Burst.tIssue = os_getTime();
+        this->startRadio(RADIO_TX);
+        return false;
+        }
+    }
+
+// The LMIC sets LMIC.txend to the time of the tx-done interrupt.
+void cTest::txBurstDone(osjob_t *job)
+    {
+    auto &burst = gTest.m_Tx.Burst;
+
+    burst.tLastDone = LMIC.txend;
+    burst.Latency.add(float(osticks2us(LMIC.txend - burst.tIssue)));
+    gTest.dutyCycleRecord(burst.tIssue, gTest.m_Tx.AirtimeUs);
+    gTest.m_Tx.fIdle = true;
+    gTest.m_fsm.eval();
+    }
+
+void cTest::txBurstPrintStats() const
+    {
+    auto const &tx = this->m_Tx;
+    auto const &burst = tx.Burst;
+
+    if (tx.nSent == 0)
+        return;
+
+    auto const tElapsed = osticks2us(burst.tLastDone - burst.tFirst);
+    std::uint32_t const ppsX100 = tElapsed <= 0
+                    ? 0
+                    : std::uint32_t(
+                        std::uint64_t(tx.nSent) * 100u * 1000000u / std::uint32_t(tElapsed)
+                        );
+
+    gCatena.SafePrintf(
+        "Burst: %lu packets in %ld ms, %lu.%02lu packets/s\n",
+        (unsigned long) tx.nSent,
+        (long) (tElapsed / 1000),
+        (unsigned long) (ppsX100 / 100),
+        (unsigned long) (ppsX100 % 100)
+        );
+
+    gCatena.SafePrintf(
+        "Tx-complete latency: mean %ld us, min %ld us, max %ld us, stddev %ld us\n",
+        long(burst.Latency.getMean()),
+        long(burst.Latency.getMin()),
+        long(burst.Latency.getMax()),
+        long(burst.Latency.getStdDev())
+        );
+
+    if (burst.Gap.getCount() != 0)
+        {
+        gCatena.SafePrintf(
+            "Tx-complete to next start: mean %ld us, min %ld us, max %ld us, stddev %ld us\n",
+            long(burst.Gap.getMean()),
+            long(burst.Gap.getMin()),
+            long(burst.Gap.getMax()),
+            long(burst.Gap.getStdDev())
+            );
+        }
+    }
@@ -0,0 +1,134 @@
+/*
+
+Module:  rwc_nst_test_cTest_txCarrier.cpp
+
+Function:
+    cTest::txCarrierTest() implementation
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_cTest.h"
+
+#include "rwc_nst_test.h"
+#include "rwc_nst_test_radio.h"
+
+// carrier test driver
+// fEntry is true to start a test, false subequently.
+// The carrier test keeps the transmitter on until canceled by `q`, or
+// for `param TxCarrierMs` if non-zero. With m_Tx.Carrier.fCw set, the
+// radio sends an unmodulated carrier at `param Frequency`; otherwise it
+// sends a LoRa preamble at the current SF/BW, restarted whenever the
+// 65535-symbol preamble runs out. Either way, an analyzer can measure
+// power and frequency without waiting for bursts.
+bool cTest::txCarrierTest(
+    bool fEntry
+    )
+    {
+    auto &tx = this->m_Tx;
+    auto &carrier = tx.Carrier;
+
+    if (fEntry)
+        {
+        this->m_fStopTest = false;
+        carrier.fTimed = this->m_params.TxCarrierMs != 0;
+        carrier.nRestart = 0;
+
+        if (carrier.fCw)
+            gCatena.SafePrintf("Start CW: ");
+        else if (this->m_params.SpreadingFactor == FSK)
+            {
+            gCatena.SafePrintf("** preamble-only transmit needs a LoRa SpreadingFactor **\n");
+            return true;
+            }
+        else
+            gCatena.SafePrintf("Start preamble-only TX: ");
+
+        if (carrier.fTimed)
+            gCatena.SafePrintf("%u ms. ", this->m_params.TxCarrierMs);
+        else
+            gCatena.SafePrintf("until canceled by `q` command. ");
+
+        this->setupLMIC(this->m_params);
+
+        // the carrier is sent with the FSK modem; the LMIC still sets
+        // frequency and power.
+        if (carrier.fCw)
+            LMIC.rps = makeRps(FSK, BW125, CR_4_5, 0, 0);
+
+        // a short frame; only the preamble is of interest, and it
+        // keeps the gap at each restart small.
+        os_radio(RADIO_RST);
+        LMIC.frame[0] = 0;
+        LMIC.dataLen = 1;
+
+        this->txCarrierStart();
+        carrier.tFirst = os_getTime();
+        }
+
+    os_runloop_once();
+
+    bool fDone = false;
+    auto const tNow = os_getTime();
+
+    if (this->m_fStopTest)
+        {
+        gCatena.SafePrintf("TX stopped");
+        fDone = true;
+        }
+    else if (carrier.fTimed &&
+             tNow - carrier.tFirst >= ms2osticks(this->m_params.TxCarrierMs))
+        {
+        gCatena.SafePrintf("TX complete");
+        fDone = true;
+        }
+    else if (tx.fIdle)
+        {
+        ++carrier.nRestart;
+        this->txCarrierStart();
+        }
+
+    if (fDone)
+        {
+        // the LMIC never rewrites the registers the carrier changed, so
+        // put them back for the tests that follow.
+        os_clearCallback(&LMIC.osjob);
+        os_radio(RADIO_RST);
+        if (carrier.fCw)
+            cRadio::endCw(carrier.CwSave);
+        else
+            cRadio::setLoraPreamble(this->m_params.Preamble);
+        gCatena.SafePrintf(
+            " after %ld ms", (long) osticks2ms(tNow - carrier.tFirst)
+            );
+        if (! carrier.fCw)
+            gCatena.SafePrintf(", %lu preamble restarts", (unsigned long) carrier.nRestart);
+        gCatena.SafePrintf(".\n");
+        }
+
+    return fDone;
+    }
+
+void cTest::txCarrierStart()
+    {
+    this->m_Tx.fIdle = false;
+    LMIC.osjob.func = cTest::txCarrierDone;
+    os_radio(RADIO_TX);
+
+    if (this->m_Tx.Carrier.fCw)
+        cRadio::startCw(this->m_Tx.Carrier.CwSave);
+    else
+        cRadio::startLongPreamble();
+    }
+
+// only reached for preamble-only transmissions; CW never ends by itself.
+void cTest::txCarrierDone(osjob_t *job)
+    {
+    gTest.m_Tx.fIdle = true;
+    gTest.m_fsm.eval();
+    }
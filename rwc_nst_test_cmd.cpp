@@ -16,6 +16,7 @@ Author:
 #include "rwc_nst_test_cmd.h"
 
 #include "rwc_nst_test.h"
+#include "rwc_nst_test_airtime.h"
 #include "rwc_nst_test_lmiclog.h"
 #include <strings.h>
 
@@ -28,6 +29,13 @@ McciCatena::cCommandStream::CommandFn cmdLog;
 McciCatena::cCommandStream::CommandFn cmdQuit;
 McciCatena::cCommandStream::CommandFn cmdTxWindowTest;
 McciCatena::cCommandStream::CommandFn cmdRxQuality;
+McciCatena::cCommandStream::CommandFn cmdRxDump;
+McciCatena::cCommandStream::CommandFn cmdTxBurstTest;
+McciCatena::cCommandStream::CommandFn cmdTxCw;
+McciCatena::cCommandStream::CommandFn cmdTxPreamble;
+McciCatena::cCommandStream::CommandFn cmdSweep;
+McciCatena::cCommandStream::CommandFn cmdDutyCycle;
+McciCatena::cCommandStream::CommandFn cmdSymbolTable;
 
 using namespace McciCatena;
 
@@ -44,11 +52,18 @@ static const cCommandStream::cEntry sMyExtraCommmands[] =
         { "rx", cmdRxTest },
         { "rw", cmdRxWindowTest },
         { "tw", cmdTxWindowTest },
+        { "tb", cmdTxBurstTest },
+        { "cw", cmdTxCw },
+        { "txpre", cmdTxPreamble },
+        { "sweep", cmdSweep },
+        { "duty", cmdDutyCycle },
+        { "symtab", cmdSymbolTable },
         { "count", cmdRxCount },
         { "param", cmdParam },
         { "log", cmdLog },
         { "q", cmdQuit },
         { "rq", cmdRxQuality },
+        { "rxdump", cmdRxDump },
         // { "debugmask", cmdDebugMask },
         // other commands go here....
         };
@@ -302,6 +317,209 @@ cCommandStream::CommandStatus cmdTxWindowTest(
 
 /*
 
+Name:   ::cmdTxBurstTest()
+
+Function:
+    Command dispatcher for "tb" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdTxBurstTest;
+
+    McciCatena::cCommandStream::CommandStatus cmdTxBurstTest(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "tb" command takes no arguments. It starts a transmit burst
+    test: `param TxTestCount` frames (or until canceled by 'q' if zero)
+    are sent back to back, and the achieved frame rate, tx-complete
+    latency and turnaround gap are reported.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successfully started.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdTxBurstTest(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+
+    if (argc != 1)
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    if (! gTest.evSendStartTxBurst())
+        {
+        pThis->printf("busy\n");
+        return cCommandStream::CommandStatus::kError;
+        }
+
+    return cCommandStream::CommandStatus::kSuccess;
+    }
+
+/*
+
+Name:   ::cmdTxCw()
+
+Function:
+    Command dispatcher for "cw" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdTxCw;
+
+    McciCatena::cCommandStream::CommandStatus cmdTxCw(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "cw" command takes no arguments. It transmits an unmodulated
+    carrier at `param Frequency` and `param TxPower` until canceled by
+    'q', or for `param TxCarrierMs` if that is non-zero.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successfully started.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdTxCw(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+
+    if (argc != 1)
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    if (! gTest.evSendStartTxCw())
+        {
+        pThis->printf("busy\n");
+        return cCommandStream::CommandStatus::kError;
+        }
+
+    return cCommandStream::CommandStatus::kSuccess;
+    }
+
+/*
+
+Name:   ::cmdTxPreamble()
+
+Function:
+    Command dispatcher for "txpre" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdTxPreamble;
+
+    McciCatena::cCommandStream::CommandStatus cmdTxPreamble(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "txpre" command takes no arguments. It transmits a continuous
+    LoRa preamble with the current spreading factor and bandwidth
+    until canceled by 'q', or for `param TxCarrierMs` if that is
+    non-zero.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successfully started.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdTxPreamble(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+
+    if (argc != 1)
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    if (! gTest.evSendStartTxPreamble())
+        {
+        pThis->printf("busy\n");
+        return cCommandStream::CommandStatus::kError;
+        }
+
+    return cCommandStream::CommandStatus::kSuccess;
+    }
+
+/*
+
+Name:   ::cmdSweep()
+
+Function:
+    Command dispatcher for "sweep" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdSweep;
+
+    McciCatena::cCommandStream::CommandStatus cmdSweep(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "sweep" command takes no arguments. It transmits
+    `param Sweep.Count` frames at each combination of
+    `param Sweep.SF`, `param Sweep.Freq` and `param Sweep.Power`,
+    printing one record per point.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successfully started.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdSweep(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+
+    if (argc != 1)
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    if (! gTest.evSendStartSweep())
+        {
+        pThis->printf("busy\n");
+        return cCommandStream::CommandStatus::kError;
+        }
+
+    return cCommandStream::CommandStatus::kSuccess;
+    }
+
+/*
+
 Name:   ::cmdRxCount()
 
 Function:
@@ -349,6 +567,118 @@ cCommandStream::CommandStatus cmdRxCount(
 
 /*
 
+Name:   ::cmdDutyCycle()
+
+Function:
+    Command dispatcher for "duty" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdDutyCycle;
+
+    McciCatena::cCommandStream::CommandStatus cmdDutyCycle(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "duty" command prints the transmit airtime used in the
+    trailing `param DutyCycle.Window`, as a percentage, with the limit
+    and the number of transmits that exceeded it. "duty reset"
+    discards the history. Unlike "count", it doesn't stop a running
+    test, so it can be used during a soak run.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successful.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdDutyCycle(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+    if (argc == 2 && strcasecmp(argv[1], "reset") == 0)
+        gTest.dutyCycleReset();
+    else if (argc != 1)
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    gTest.dutyCyclePrintStatus();
+    return cCommandStream::CommandStatus::kSuccess;
+    }
+
+/*
+
+Name:   ::cmdSymbolTable()
+
+Function:
+    Command dispatcher for "symtab" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdSymbolTable;
+
+    McciCatena::cCommandStream::CommandStatus cmdSymbolTable(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "symtab" command prints the compile-time symbol timing table
+    (cAirtime::kSymbolTable) as CSV, one line per SF/BW pair: symbol,
+    half-symbol and default preamble times, in microseconds and in
+    LMIC os ticks. It's meant for host tools that need to agree
+    with the sketch's timing.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successful.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdSymbolTable(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+    if (argc != 1)
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    pThis->printf("sf,bw,symbol_us,half_symbol_us,preamble_us,symbol_ticks,half_symbol_ticks,preamble_ticks\n");
+    for (auto const &t : cAirtime::kSymbolTable)
+        {
+        if (t.sf == FSK)
+            pThis->printf("fsk,-,");
+        else
+            pThis->printf("%u,%u,", cAirtime::sfNumber(t.sf), 125u << t.bw);
+
+        pThis->printf(
+            "%lu,%lu,%lu,%ld,%ld,%ld\n",
+            (unsigned long) t.symbolUs,
+            (unsigned long) t.halfSymbolUs,
+            (unsigned long) t.preambleUs,
+            (long) t.symbolTicks,
+            (long) t.halfSymbolTicks,
+            (long) t.preambleTicks
+            );
+        }
+
+    return cCommandStream::CommandStatus::kSuccess;
+    }
+
+/*
+
 Name:   ::cmdParam()
 
 Function:
@@ -393,7 +723,7 @@ cCommandStream::CommandStatus cmdParam(
     case 1:
         for (auto & p : cTest::ParamInfo)
             {
-            char buf[64];
+            char buf[80];
             if (gTest.getParam(p.getName(), buf, sizeof(buf)))
                 pThis->printf("%s: %s\n", p.getName(), buf);
             }
@@ -401,7 +731,7 @@ cCommandStream::CommandStatus cmdParam(
 
     case 2:
         {
-        char buf[64];
+        char buf[80];
         if (gTest.getParam(argv[1], buf, sizeof(buf)))
             pThis->printf("%s\n", buf);
         else if (strcasecmp(argv[1], "help") == 0|| argv[1][0] == '?')
@@ -579,3 +909,56 @@ cCommandStream::CommandStatus cmdRxQuality(
 
     return cCommandStream::CommandStatus::kSuccess;
     }
+
+/*
+
+Name:   ::cmdRxDump()
+
+Function:
+    Command dispatcher for "rxdump" command.
+
+Definition:
+    McciCatena::cCommandStream::CommandFn cmdRxDump;
+
+    McciCatena::cCommandStream::CommandStatus cmdRxDump(
+        cCommandStream *pThis,
+        void *pContext,
+        int argc,
+        char **argv
+        );
+
+Description:
+    The "rxdump" command dumps the packets captured by the most recent
+    rx or rw test, oldest first. It has two forms:
+
+    1. "rxdump" or "rxdump text" prints one line per packet.
+    2. "rxdump bin" writes the capture as binary records, one line of
+       hex per record; see cTest::cRxCapture::writeBinary() for the
+       format.
+
+Returns:
+    cCommandStream::CommandStatus::kSuccess if successful.
+    Some other value for failure.
+
+*/
+
+// argv[0] is the matched command name.
+
+cCommandStream::CommandStatus cmdRxDump(
+    cCommandStream *pThis,
+    void *pContext,
+    int argc,
+    char **argv
+    )
+    {
+    auto const &capture = gTest.getRxCapture();
+
+    if (argc == 1 || (argc == 2 && strcasecmp(argv[1], "text") == 0))
+        capture.printText(pThis);
+    else if (argc == 2 && strcasecmp(argv[1], "bin") == 0)
+        capture.writeBinary(pThis);
+    else
+        return cCommandStream::CommandStatus::kInvalidParameter;
+
+    return cCommandStream::CommandStatus::kSuccess;
+    }
@@ -0,0 +1,108 @@
+/*
+
+Module:  rwc_nst_test_dutycycle.cpp
+
+Function:
+    cDutyCycle implementation.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_dutycycle.h"
+
+void cDutyCycle::begin(std::uint32_t windowSec)
+    {
+    if (windowSec > kWindowSecMax)
+        windowSec = kWindowSecMax;
+    if (windowSec == 0)
+        windowSec = 1;
+
+    if (windowSec == this->m_windowSec)
+        return;
+
+    this->m_windowSec = windowSec;
+    this->m_tBucket = sec2osticks(windowSec) / kBuckets;
+    this->reset();
+    }
+
+void cDutyCycle::reset()
+    {
+    for (auto &b : this->m_bucket)
+        b = 0;
+    this->m_head = 0;
+    this->m_usedUs = 0;
+    this->m_fStarted = false;
+    }
+
+void cDutyCycle::advance(ostime_t tNow)
+    {
+    if (! this->m_fStarted)
+        {
+        this->m_tHead = tNow;
+        this->m_fStarted = true;
+        return;
+        }
+
+    // after a long idle time, everything has expired.
+    if (tNow - this->m_tHead >= this->m_tBucket * ostime_t(kBuckets))
+        {
+        for (auto &b : this->m_bucket)
+            b = 0;
+        this->m_usedUs = 0;
+        this->m_tHead = tNow;
+        return;
+        }
+
+    while (tNow - this->m_tHead >= this->m_tBucket)
+        {
+        this->m_tHead += this->m_tBucket;
+        if (++this->m_head == kBuckets)
+            this->m_head = 0;
+
+        // the new head is the oldest bucket; it leaves the window.
+        this->m_usedUs -= this->m_bucket[this->m_head];
+        this->m_bucket[this->m_head] = 0;
+        }
+    }
+
+void cDutyCycle::add(ostime_t tStart, std::uint32_t airtimeUs)
+    {
+    this->advance(tStart);
+    this->m_bucket[this->m_head] += airtimeUs;
+    this->m_usedUs += airtimeUs;
+    }
+
+std::uint32_t cDutyCycle::getUsedUs(ostime_t tNow)
+    {
+    this->advance(tNow);
+    return this->m_usedUs;
+    }
+
+ostime_t cDutyCycle::getDelay(
+    ostime_t tNow,
+    std::uint32_t airtimeUs,
+    std::uint32_t budgetUs
+    )
+    {
+    std::uint32_t used = this->getUsedUs(tNow);
+
+    if (used + airtimeUs <= budgetUs)
+        return 0;
+
+    // retire buckets oldest first until the frame fits. The k-th
+    // oldest bucket leaves the window at m_tHead + (k + 1) * m_tBucket.
+    for (unsigned k = 0; k < kBuckets; ++k)
+        {
+        used -= this->m_bucket[(this->m_head + 1 + k) % kBuckets];
+        if (used + airtimeUs <= budgetUs)
+            return this->m_tHead + ostime_t(k + 1) * this->m_tBucket - tNow;
+        }
+
+    // the frame alone is more than the budget; wait a whole window.
+    return this->m_tBucket * ostime_t(kBuckets);
+    }
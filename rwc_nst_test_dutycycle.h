@@ -0,0 +1,81 @@
+/*
+
+Module:  rwc_nst_test_dutycycle.h
+
+Function:
+    Sliding-window duty-cycle accounting for the non-signaling test app.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#ifndef _rwc_nst_test_dutycycle_h_
+# define _rwc_nst_test_dutycycle_h_
+
+#pragma once
+
+#include <cstdint>
+#include <arduino_lmic.h>
+
+/****************************************************************************\
+|
+|   cDutyCycle: airtime used in the trailing window
+|
+\****************************************************************************/
+
+// The window is divided into kBuckets equal buckets, each holding the
+// airtime of the transmissions that started in it, so memory is fixed
+// however fast frames are sent. Airtime leaves the window a whole
+// bucket at a time, which errs on the side of over-counting.
+class cDutyCycle
+    {
+public:
+    static constexpr unsigned kBuckets = 60;
+    // longest supported window; keeps the airtime sum (us) in 32 bits.
+    static constexpr std::uint32_t kWindowSecMax = 3600;
+
+    // (re)configure for a window of windowSec; history is discarded
+    // only if the window changes.
+    void begin(std::uint32_t windowSec);
+
+    // discard all history.
+    void reset();
+
+    // account for a transmission of airtimeUs starting at tStart.
+    void add(ostime_t tStart, std::uint32_t airtimeUs);
+
+    // airtime (us) in the window ending at tNow.
+    std::uint32_t getUsedUs(ostime_t tNow);
+
+    // the window length, in seconds.
+    std::uint32_t getWindowSec() const
+        {
+        return this->m_windowSec;
+        }
+
+    // return how long to wait from tNow before airtimeUs more can be
+    // sent without exceeding budgetUs in the window; zero if it fits now.
+    ostime_t getDelay(ostime_t tNow, std::uint32_t airtimeUs, std::uint32_t budgetUs);
+
+private:
+    // retire buckets that have slid out of the window at tNow.
+    void advance(ostime_t tNow);
+
+    std::uint32_t   m_bucket[kBuckets];
+    // start time of the newest bucket
+    ostime_t        m_tHead;
+    // length of one bucket
+    ostime_t        m_tBucket;
+    // index of the newest bucket
+    unsigned        m_head;
+    // running sum of m_bucket[] (us)
+    std::uint32_t   m_usedUs;
+    std::uint32_t   m_windowSec = 0;
+    bool            m_fStarted = false;
+    };
+
+#endif // _rwc_nst_test_dutycycle_h_
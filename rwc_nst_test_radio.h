@@ -0,0 +1,231 @@
+/*
+
+Module:  rwc_nst_test_radio.h
+
+Function:
+    Direct SX127x register access for the non-signaling test app.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#ifndef _rwc_nst_test_radio_h_
+# define _rwc_nst_test_radio_h_
+
+#pragma once
+
+#include <cstdint>
+#include <arduino_lmic.h>
+#include <hal/hal.h>
+
+/****************************************************************************\
+|
+|   cRadio: the few SX127x registers that the LMIC doesn't expose.
+|
+\****************************************************************************/
+
+// The LMIC owns the radio; these are used only between LMIC operations,
+// or immediately after the LMIC has started an operation, to read back
+// status or adjust settings the LMIC doesn't provide for.
+class cRadio
+    {
+public:
+    enum Reg : std::uint8_t
+        {
+        kRegOpMode              = 0x01,
+        kRegFskFdevMsb          = 0x04,
+        kRegFskFdevLsb          = 0x05,
+        kRegLoraFifoAddrPtr     = 0x0D,
+        kRegLoraFifoTxBaseAddr  = 0x0E,
+        kRegLoraIrqFlagsMask    = 0x11,
+        kRegLoraIrqFlags        = 0x12,
+        kRegLoraPreambleMsb     = 0x20,
+        kRegLoraPreambleLsb     = 0x21,
+        kRegLoraFeiMsb          = 0x28,
+        kRegLoraFeiMid          = 0x29,
+        kRegLoraFeiLsb          = 0x2A,
+        kRegLoraSyncWord        = 0x39,
+        kRegFskPacketConfig2    = 0x31,
+        };
+
+    // RegOpMode mode field
+    enum Mode : std::uint8_t
+        {
+        kModeSleep              = 0,
+        kModeStandby            = 1,
+        kModeTx                 = 3,
+        };
+
+    // RegOpMode LongRangeMode bit: 1 selects the LoRa modem.
+    static constexpr std::uint8_t kOpModeLongRange = 1u << 7;
+
+    // RegPacketConfig2 DataMode bit: 1 for packet, 0 for continuous.
+    static constexpr std::uint8_t kFskPacketConfig2DataMode = 1u << 6;
+
+    // crystal frequency, used for converting register values.
+    static constexpr std::uint32_t kFxoscHz = 32000000;
+
+    // LoRa IRQ flags (RegIrqFlags, RegIrqFlagsMask)
+    enum LoraIrq : std::uint8_t
+        {
+        kLoraIrqRxTimeout       = 1u << 7,
+        kLoraIrqRxDone          = 1u << 6,
+        kLoraIrqPayloadCrcError = 1u << 5,
+        kLoraIrqValidHeader     = 1u << 4,
+        kLoraIrqTxDone          = 1u << 3,
+        };
+
+    static std::uint8_t readReg(std::uint8_t reg)
+        {
+        std::uint8_t v;
+        hal_spi_read(reg & 0x7Fu, &v, 1);
+        return v;
+        }
+
+    static void writeReg(std::uint8_t reg, std::uint8_t v)
+        {
+        hal_spi_write(reg | 0x80u, &v, 1);
+        }
+
+    // return true if the radio is in sleep or standby, i.e. not
+    // transmitting or receiving. Doesn't wait.
+    static bool isIdle()
+        {
+        auto const mode = readReg(kRegOpMode) & 0x07u;
+        return mode == kModeSleep || mode == kModeStandby;
+        }
+
+    // change the RegOpMode mode field, keeping the modem selection.
+    static void setMode(Mode mode)
+        {
+        writeReg(kRegOpMode, std::uint8_t((readReg(kRegOpMode) & ~0x07u) | mode));
+        }
+
+    // the FSK registers that startCw() changes; the LMIC never rewrites
+    // them, so endCw() must put them back.
+    struct CwSave_t
+        {
+        std::uint8_t    FdevMsb;
+        std::uint8_t    FdevLsb;
+        std::uint8_t    PacketConfig2;
+        };
+
+    // Call immediately after the LMIC has started an FSK transmission.
+    // Re-enter tx with zero deviation in continuous mode: the packet
+    // handler is bypassed, so the radio sends an unmodulated carrier
+    // (regardless of DIO2) until it's reset.
+    static void startCw(CwSave_t &save)
+        {
+        setMode(kModeStandby);
+        save.FdevMsb = readReg(kRegFskFdevMsb);
+        save.FdevLsb = readReg(kRegFskFdevLsb);
+        save.PacketConfig2 = readReg(kRegFskPacketConfig2);
+        writeReg(kRegFskFdevMsb, 0);
+        writeReg(kRegFskFdevLsb, 0);
+        writeReg(
+            kRegFskPacketConfig2,
+            std::uint8_t(readReg(kRegFskPacketConfig2) & ~kFskPacketConfig2DataMode)
+            );
+        setMode(kModeTx);
+        }
+
+    // Call after os_radio(RADIO_RST) ends a CW transmission, while the
+    // FSK modem is still selected.
+    static void endCw(const CwSave_t &save)
+        {
+        writeReg(kRegFskFdevMsb, save.FdevMsb);
+        writeReg(kRegFskFdevLsb, save.FdevLsb);
+        writeReg(kRegFskPacketConfig2, save.PacketConfig2);
+        }
+
+    // Call immediately after the LMIC has started a LoRa transmission.
+    // Re-enter tx with the longest preamble (65535 symbols); the frame
+    // already in the FIFO follows, and TxDone is raised as usual.
+    static void startLongPreamble()
+        {
+        setMode(kModeStandby);
+        writeReg(kRegLoraPreambleMsb, 0xFF);
+        writeReg(kRegLoraPreambleLsb, 0xFF);
+        writeReg(kRegLoraFifoAddrPtr, readReg(kRegLoraFifoTxBaseAddr));
+        setMode(kModeTx);
+        }
+
+
+    // Set the LoRa preamble length. The LMIC never writes it, so the
+    // value holds across operations; call between operations, with the
+    // radio in sleep or standby. The register is only visible with the
+    // LoRa modem selected, so this selects it (in sleep) if need be, as
+    // the LMIC would anyway when starting a LoRa operation.
+    static void setLoraPreamble(std::uint16_t nPreamble)
+        {
+        auto const opMode = readReg(kRegOpMode);
+
+        if (! (opMode & kOpModeLongRange))
+            {
+            writeReg(kRegOpMode, std::uint8_t((opMode & ~0x07u) | kModeSleep));
+            writeReg(kRegOpMode, std::uint8_t((opMode & ~0x07u) | kOpModeLongRange | kModeSleep));
+            }
+        writeReg(kRegLoraPreambleMsb, std::uint8_t(nPreamble >> 8));
+        writeReg(kRegLoraPreambleLsb, std::uint8_t(nPreamble));
+        }
+
+    // The LMIC writes the LoRaWAN sync word as it starts each LoRa
+    // operation, with no chance to change it before the modem starts.
+    // Call immediately after os_radio() has started one: the radio is
+    // put in standby, the sync word is written, and the same operation
+    // is re-entered. A transmission restarts from the top of the FIFO;
+    // either way the operation starts a few SPI transfers late.
+    static void restartWithSyncWord(std::uint8_t syncWord)
+        {
+        auto const mode = Mode(readReg(kRegOpMode) & 0x07u);
+
+        if (mode == kModeSleep || mode == kModeStandby)
+            return;
+
+        setMode(kModeStandby);
+        writeReg(kRegLoraSyncWord, syncWord);
+        if (mode == kModeTx)
+            writeReg(kRegLoraFifoAddrPtr, readReg(kRegLoraFifoTxBaseAddr));
+        setMode(mode);
+        }
+
+    // Return the LoRa frequency error estimate for the last packet, in Hz.
+    // The register value is a 20-bit two's complement number scaled by
+    // 2^24 / Fxosc * (BW / 500 kHz). Registers are retained in sleep,
+    // so this can be called after the LMIC has completed the receive.
+    static std::int32_t getLoraFreqErrorHz(bw_t bw)
+        {
+        std::uint32_t fei;
+
+        fei  = std::uint32_t(readReg(kRegLoraFeiMsb) & 0x0Fu) << 16;
+        fei |= std::uint32_t(readReg(kRegLoraFeiMid)) << 8;
+        fei |= readReg(kRegLoraFeiLsb);
+
+        // sign extend from bit 19.
+        std::int32_t const sfei = std::int32_t(fei ^ 0x80000u) - 0x80000;
+
+        // (2^24 / 32 MHz) * (125 << bw) / 500 == (1 << bw) * 2^24 / 128 MHz
+        return std::int32_t(
+                    (std::int64_t(sfei) * (std::int64_t(1) << (24 + bw))) /
+                    (std::int64_t(kFxoscHz) * 4)
+                    );
+        }
+
+    // The LMIC only unmasks RxDone and RxTimeout for receive, so the
+    // CRC error flag never latches. Call after starting a LoRa receive
+    // to let PayloadCrcError latch as well; it is not routed to any DIO
+    // the LMIC watches.
+    static void enableRxDiagIrqs()
+        {
+        writeReg(
+            kRegLoraIrqFlagsMask,
+            std::uint8_t(~(kLoraIrqRxDone | kLoraIrqRxTimeout | kLoraIrqPayloadCrcError))
+            );
+        }
+    };
+
+#endif // _rwc_nst_test_radio_h_
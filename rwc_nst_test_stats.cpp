@@ -0,0 +1,86 @@
+/*
+
+Module:  rwc_nst_test_stats.cpp
+
+Function:
+    Statistics helpers for the non-signaling test app.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#include "rwc_nst_test_stats.h"
+
+#include <cmath>
+
+float cStats::normalQuantile(float c)
+    {
+    if (c <= 0.5f)
+        return 0.0f;
+    if (c >= 0.9999f)
+        c = 0.9999f;
+
+    const float t = sqrtf(-2.0f * logf(1.0f - c));
+
+    return t - (2.515517f + t * (0.802853f + t * 0.010328f)) /
+               (1.0f + t * (1.432788f + t * (0.189269f + t * 0.001308f)));
+    }
+
+bool cStats::wilson(
+    std::uint32_t k,
+    std::uint32_t n,
+    float z,
+    float &lower,
+    float &upper
+    )
+    {
+    if (n == 0)
+        return false;
+
+    const float fn = float(n);
+    const float p = float(k) / fn;
+    const float z2 = z * z;
+    const float denom = 1.0f + z2 / fn;
+    const float center = (p + z2 / (2.0f * fn)) / denom;
+    const float half = z * sqrtf(p * (1.0f - p) / fn + z2 / (4.0f * fn * fn)) / denom;
+
+    lower = center - half;
+    upper = center + half;
+    if (lower < 0.0f)
+        lower = 0.0f;
+    if (upper > 1.0f)
+        upper = 1.0f;
+
+    return true;
+    }
+
+cStats::Decision cStats::wilsonCompare(
+    std::uint32_t k,
+    std::uint32_t n,
+    float z,
+    float threshold
+    )
+    {
+    float lower, upper;
+
+    if (! wilson(k, n, z, lower, upper))
+        return Decision::Undecided;
+    else if (upper < threshold)
+        return Decision::Below;
+    else if (lower > threshold)
+        return Decision::Above;
+    else
+        return Decision::Undecided;
+    }
+
+float cRunningStats::getStdDev() const
+    {
+    if (this->m_n < 2)
+        return 0.0f;
+
+    return sqrtf(this->m_m2 / float(this->m_n - 1));
+    }
@@ -0,0 +1,112 @@
+/*
+
+Module:  rwc_nst_test_stats.h
+
+Function:
+    Small statistics helpers for the non-signaling test app.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	2019
+
+*/
+
+#ifndef _rwc_nst_test_stats_h_
+# define _rwc_nst_test_stats_h_
+
+#pragma once
+
+#include <cstdint>
+
+/****************************************************************************\
+|
+|   cStats: binomial confidence bounds
+|
+\****************************************************************************/
+
+class cStats
+    {
+public:
+    // the result of a sequential check against a threshold.
+    enum class Decision : std::uint8_t
+        {
+        Undecided,  // interval straddles the threshold
+        Below,      // interval entirely below the threshold
+        Above,      // interval entirely above the threshold
+        };
+
+    // return the one-sided normal quantile z for confidence c,
+    // 0.5 <= c < 1. Abramowitz & Stegun 26.2.23; |error| < 4.5e-4.
+    static float normalQuantile(float c);
+
+    // compute the Wilson score interval for k successes in n trials,
+    // using normal quantile z. Returns false if n is zero.
+    static bool wilson(
+        std::uint32_t k,
+        std::uint32_t n,
+        float z,
+        float &lower,
+        float &upper
+        );
+
+    // compare the Wilson interval for k/n against threshold.
+    static Decision wilsonCompare(
+        std::uint32_t k,
+        std::uint32_t n,
+        float z,
+        float threshold
+        );
+    };
+
+/****************************************************************************\
+|
+|   cRunningStats: count, mean, deviation and extremes of a sample stream
+|
+\****************************************************************************/
+
+// Welford's method; no samples are stored.
+class cRunningStats
+    {
+public:
+    cRunningStats() {};
+
+    void reset()
+        {
+        this->m_n = 0;
+        this->m_mean = this->m_m2 = 0.0f;
+        this->m_min = this->m_max = 0.0f;
+        }
+
+    void add(float x)
+        {
+        ++this->m_n;
+        if (this->m_n == 1)
+            this->m_min = this->m_max = x;
+        else if (x < this->m_min)
+            this->m_min = x;
+        else if (x > this->m_max)
+            this->m_max = x;
+
+        const float delta = x - this->m_mean;
+        this->m_mean += delta / float(this->m_n);
+        this->m_m2 += delta * (x - this->m_mean);
+        }
+
+    std::uint32_t getCount() const  { return this->m_n; }
+    float getMean() const           { return this->m_mean; }
+    float getMin() const            { return this->m_min; }
+    float getMax() const            { return this->m_max; }
+    // sample standard deviation
+    float getStdDev() const;
+
+private:
+    std::uint32_t   m_n = 0;
+    float           m_mean = 0.0f;
+    float           m_m2 = 0.0f;
+    float           m_min = 0.0f;
+    float           m_max = 0.0f;
+    };
+
+#endif // _rwc_nst_test_stats_h_